@@ -5,6 +5,22 @@
 #include <vector>
 #include <stdexcept>
 #include <algorithm>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <x86intrin.h>  // __rdtsc
+#define SM4_BENCH_HAVE_RDTSC 1
+#endif
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 class SM4 {
 private:
@@ -266,6 +282,54 @@ void printHex(const uint8_t* data, size_t len) {
 }
 
 
+// 基准测试矩阵配置：负载大小 × AAD 大小 × 线程数
+struct GcmBenchConfig {
+    enum class Format { Table, Csv, Json };
+
+    std::vector<size_t> payloadSizes;
+    std::vector<size_t> aadSizes;
+    std::vector<unsigned> threadCounts;
+    double warmupSeconds = 0.05;   // 每个线程的预热时长
+    double measureSeconds = 0.5;   // 每个线程的计时时长
+    size_t minCalls = 5;           // 至少调用次数（大负载时生效）
+    size_t maxCalls = 1000000;     // 最多调用次数（小负载时生效）
+    bool pinThreads = true;        // 是否绑定线程到CPU核心
+    Format format = Format::Table;
+
+    // 默认矩阵：16B 到 1MB（每档×4），AAD 0/32/256 字节，1 线程与全部核心。
+    // 每个格点至少 minCalls 次调用，更大的负载单格就要数秒且每线程占用数倍负载的内存，
+    // 需要时用 --sizes 显式指定（如 --sizes 16M,64M）
+    static GcmBenchConfig defaults() {
+        GcmBenchConfig cfg;
+        for (size_t s = 16; s <= 1024 * 1024; s *= 4) {
+            cfg.payloadSizes.push_back(s);
+        }
+        cfg.aadSizes = {0, 32, 256};
+        unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        cfg.threadCounts.push_back(1);
+        if (hw > 1) {
+            cfg.threadCounts.push_back(hw);
+        }
+        return cfg;
+    }
+};
+
+// 单个矩阵格点的测试结果
+struct GcmBenchResult {
+    const char* op;
+    size_t payloadSize;
+    size_t aadSize;
+    unsigned threads;
+    size_t calls;          // 所有线程的计时调用总数
+    double p50Us;
+    double p99Us;
+    double p999Us;
+    double meanUs;
+    double cyclesPerByte;  // 每个线程所在核心上的周期数 / 负载字节
+    double callsPerSec;    // 所有线程合计
+    double mbPerSec;       // 所有线程合计
+};
+
 // SM4-GCM工作模式实现
 class SM4_GCM {
 private:
@@ -571,9 +635,314 @@ public:
         std::cout << "  解密速度: " << dec_speed << " MB/s\n";
         std::cout << "  总吞吐量: " << enc_speed + dec_speed << " MB/s\n";
     }
+
+    // 单个格点测试：threads 个线程各自独立加密（或解密）payload_size 字节，
+    // 记录每次调用的延迟与周期数，合并后计算分位数
+    static GcmBenchResult benchmarkCase(bool decrypting, size_t payload_size, size_t aad_size,
+                                        unsigned threads, const GcmBenchConfig& cfg) {
+        struct ThreadSamples {
+            std::vector<double> latencyUs;
+            uint64_t cycles = 0;
+            double elapsed = 0;
+        };
+        std::vector<ThreadSamples> samples(threads);
+        std::atomic<unsigned> ready(0);
+        std::atomic<bool> failed(false);
+
+        auto worker = [&](unsigned tid) {
+            if (cfg.pinThreads) {
+                pinCurrentThread(tid);
+            }
+
+            std::vector<uint8_t> key(16, 0xAA);
+            std::vector<uint8_t> iv(12, 0xBB);
+            std::vector<uint8_t> aad(aad_size, 0xCC);
+            std::vector<uint8_t> plaintext(payload_size, 0xDD);
+            std::vector<uint8_t> ciphertext(payload_size);
+            std::vector<uint8_t> decrypted(decrypting ? payload_size : 0);
+            uint8_t tag[16];
+
+            auto call = [&]() {
+                if (decrypting) {
+                    if (!decrypt(key.data(), iv.data(), iv.size(), aad.data(), aad.size(),
+                                 ciphertext.data(), ciphertext.size(), tag, sizeof(tag),
+                                 decrypted.data())) {
+                        failed = true;
+                    }
+                } else {
+                    encrypt(key.data(), iv.data(), iv.size(), aad.data(), aad.size(),
+                            plaintext.data(), plaintext.size(), ciphertext.data(), tag);
+                }
+            };
+
+            // 解密需要合法的密文和标签，先加密一次
+            encrypt(key.data(), iv.data(), iv.size(), aad.data(), aad.size(),
+                    plaintext.data(), plaintext.size(), ciphertext.data(), tag);
+
+            // 预热：至少一次调用，直到达到预热时长
+            auto warm_start = std::chrono::steady_clock::now();
+            do {
+                call();
+            } while (std::chrono::duration<double>(std::chrono::steady_clock::now() - warm_start).count()
+                     < cfg.warmupSeconds);
+
+            // 所有线程预热完成后同时开始计时
+            ready.fetch_add(1);
+            while (ready.load() < threads) {
+                std::this_thread::yield();
+            }
+
+            ThreadSamples& s = samples[tid];
+            s.latencyUs.reserve(std::min<size_t>(cfg.maxCalls, 1 << 16));
+            auto start = std::chrono::steady_clock::now();
+            auto now = start;
+            while (s.latencyUs.size() < cfg.maxCalls &&
+                   (s.latencyUs.size() < cfg.minCalls ||
+                    std::chrono::duration<double>(now - start).count() < cfg.measureSeconds)) {
+                uint64_t c0 = readCycles();
+                auto t0 = std::chrono::steady_clock::now();
+                call();
+                now = std::chrono::steady_clock::now();
+                s.cycles += readCycles() - c0;
+                s.latencyUs.push_back(std::chrono::duration<double, std::micro>(now - t0).count());
+            }
+            s.elapsed = std::chrono::duration<double>(now - start).count();
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < threads; t++) {
+            pool.emplace_back(worker, t);
+        }
+        for (auto& th : pool) {
+            th.join();
+        }
+        if (failed) {
+            throw std::runtime_error("基准测试中解密认证失败");
+        }
+
+        std::vector<double> all;
+        uint64_t cycles = 0;
+        double wall = 0;
+        for (const auto& s : samples) {
+            all.insert(all.end(), s.latencyUs.begin(), s.latencyUs.end());
+            cycles += s.cycles;
+            wall = std::max(wall, s.elapsed);
+        }
+        std::sort(all.begin(), all.end());
+
+        double sum = 0;
+        for (double v : all) {
+            sum += v;
+        }
+
+        GcmBenchResult r;
+        r.op = decrypting ? "decrypt" : "encrypt";
+        r.payloadSize = payload_size;
+        r.aadSize = aad_size;
+        r.threads = threads;
+        r.calls = all.size();
+        r.p50Us = percentile(all, 0.50);
+        r.p99Us = percentile(all, 0.99);
+        r.p999Us = percentile(all, 0.999);
+        r.meanUs = all.empty() ? 0 : sum / all.size();
+        r.cyclesPerByte = cycles ? (double)cycles / ((double)all.size() * payload_size) : 0;
+        r.callsPerSec = wall > 0 ? all.size() / wall : 0;
+        r.mbPerSec = r.callsPerSec * payload_size / (1024 * 1024);
+        return r;
+    }
+
+    // 基准测试矩阵：遍历 操作 × 负载大小 × AAD 大小 × 线程数，按配置格式输出
+    static void benchmarkMatrix(const GcmBenchConfig& cfg, std::ostream& os) {
+        bool first = true;
+        switch (cfg.format) {
+        case GcmBenchConfig::Format::Csv:
+            os << "op,payload_bytes,aad_bytes,threads,calls,p50_us,p99_us,p999_us,mean_us,"
+                  "cycles_per_byte,calls_per_sec,mb_per_sec\n";
+            break;
+        case GcmBenchConfig::Format::Json:
+            os << "{\"benchmark\":\"sm4-gcm\",\"cycles_available\":"
+               << (readCycles() ? "true" : "false") << ",\"results\":[\n";
+            break;
+        case GcmBenchConfig::Format::Table:
+            os << std::left << std::setw(8) << "op" << std::right
+               << std::setw(10) << "payload" << std::setw(6) << "aad" << std::setw(5) << "thr"
+               << std::setw(9) << "calls" << std::setw(12) << "p50(us)" << std::setw(12) << "p99(us)"
+               << std::setw(12) << "p999(us)" << std::setw(10) << "cyc/B" << std::setw(12) << "calls/s"
+               << std::setw(10) << "MB/s" << "\n";
+            break;
+        }
+
+        for (bool decrypting : {false, true}) {
+            for (size_t payload : cfg.payloadSizes) {
+                for (size_t aad : cfg.aadSizes) {
+                    for (unsigned threads : cfg.threadCounts) {
+                        GcmBenchResult r = benchmarkCase(decrypting, payload, aad, threads, cfg);
+                        writeBenchResult(r, cfg.format, first, os);
+                        first = false;
+                    }
+                }
+            }
+        }
+
+        if (cfg.format == GcmBenchConfig::Format::Json) {
+            os << "\n]}\n";
+        }
+    }
+
+private:
+    // 读取时间戳计数器，不支持的平台返回0（此时不输出周期/字节）
+    static uint64_t readCycles() {
+#ifdef SM4_BENCH_HAVE_RDTSC
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    // 将当前线程绑定到第 index 个逻辑CPU（按核心数取模）
+    static void pinCurrentThread(unsigned index) {
+        unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        unsigned cpu = index % hw;
+#if defined(_WIN32)
+        SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)cpu;
+#endif
+    }
+
+    // 最近秩分位数，sorted 须已升序
+    static double percentile(const std::vector<double>& sorted, double q) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        size_t rank = (size_t)(q * sorted.size() + 0.999999);
+        rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+        return sorted[rank - 1];
+    }
+
+    static void writeBenchResult(const GcmBenchResult& r, GcmBenchConfig::Format format,
+                                 bool first, std::ostream& os) {
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(3);
+        switch (format) {
+        case GcmBenchConfig::Format::Csv:
+            line << r.op << "," << r.payloadSize << "," << r.aadSize << "," << r.threads << ","
+                 << r.calls << "," << r.p50Us << "," << r.p99Us << "," << r.p999Us << ","
+                 << r.meanUs << "," << r.cyclesPerByte << "," << r.callsPerSec << ","
+                 << r.mbPerSec << "\n";
+            break;
+        case GcmBenchConfig::Format::Json:
+            line << (first ? "" : ",\n")
+                 << "  {\"op\":\"" << r.op << "\",\"payload_bytes\":" << r.payloadSize
+                 << ",\"aad_bytes\":" << r.aadSize << ",\"threads\":" << r.threads
+                 << ",\"calls\":" << r.calls << ",\"p50_us\":" << r.p50Us
+                 << ",\"p99_us\":" << r.p99Us << ",\"p999_us\":" << r.p999Us
+                 << ",\"mean_us\":" << r.meanUs << ",\"cycles_per_byte\":" << r.cyclesPerByte
+                 << ",\"calls_per_sec\":" << r.callsPerSec << ",\"mb_per_sec\":" << r.mbPerSec << "}";
+            break;
+        case GcmBenchConfig::Format::Table:
+            line << std::left << std::setw(8) << r.op << std::right
+                 << std::setw(10) << r.payloadSize << std::setw(6) << r.aadSize
+                 << std::setw(5) << r.threads << std::setw(9) << r.calls
+                 << std::setw(12) << r.p50Us << std::setw(12) << r.p99Us << std::setw(12) << r.p999Us
+                 << std::setw(10) << std::setprecision(2) << r.cyclesPerByte
+                 << std::setw(12) << std::setprecision(0) << r.callsPerSec
+                 << std::setw(10) << std::setprecision(2) << r.mbPerSec << "\n";
+            break;
+        }
+        os << line.str() << std::flush;
+    }
 };
 
-int main() {
+// 解析逗号分隔的大小列表，支持 K/M 后缀，如 "16,4K,1M"
+static std::vector<size_t> parseSizeList(const std::string& arg) {
+    std::vector<size_t> out;
+    std::stringstream ss(arg);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        size_t mul = 1;
+        char suffix = item.back();
+        if (suffix == 'K' || suffix == 'k') {
+            mul = 1024;
+        } else if (suffix == 'M' || suffix == 'm') {
+            mul = 1024 * 1024;
+        }
+        if (mul != 1) {
+            item.pop_back();
+        }
+        out.push_back(std::stoull(item) * mul);
+    }
+    if (out.empty()) {
+        throw std::invalid_argument("空的大小列表: " + arg);
+    }
+    return out;
+}
+
+// 基准测试模式命令行：
+//   --bench [--format table|csv|json] [--sizes 16,4K,1M] [--aad 0,32]
+//           [--threads 1,8] [--warmup 秒] [--time 秒] [--no-pin]
+static int runBenchmarkMode(int argc, char** argv) {
+    GcmBenchConfig cfg = GcmBenchConfig::defaults();
+    for (int i = 2; i < argc; i++) {
+        std::string opt = argv[i];
+        if (opt == "--no-pin") {
+            cfg.pinThreads = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "缺少参数: " << opt << std::endl;
+            return 1;
+        }
+        std::string val = argv[++i];
+        if (opt == "--format") {
+            if (val == "csv") cfg.format = GcmBenchConfig::Format::Csv;
+            else if (val == "json") cfg.format = GcmBenchConfig::Format::Json;
+            else if (val == "table") cfg.format = GcmBenchConfig::Format::Table;
+            else {
+                std::cerr << "未知输出格式: " << val << std::endl;
+                return 1;
+            }
+        } else if (opt == "--sizes") {
+            cfg.payloadSizes = parseSizeList(val);
+        } else if (opt == "--aad") {
+            cfg.aadSizes = parseSizeList(val);
+        } else if (opt == "--threads") {
+            cfg.threadCounts.clear();
+            for (size_t t : parseSizeList(val)) {
+                cfg.threadCounts.push_back((unsigned)std::max<size_t>(t, 1));
+            }
+        } else if (opt == "--warmup") {
+            cfg.warmupSeconds = std::stod(val);
+        } else if (opt == "--time") {
+            cfg.measureSeconds = std::stod(val);
+        } else {
+            std::cerr << "未知选项: " << opt << std::endl;
+            return 1;
+        }
+    }
+
+    SM4_GCM::benchmarkMatrix(cfg, std::cout);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        try {
+            return runBenchmarkMode(argc, argv);
+        } catch (const std::exception& e) {
+            std::cerr << "基准测试错误: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     // 测试SM4基本功能
     {
         std::cout << "=== SM4基本功能测试 ===" << std::endl;
@@ -4,6 +4,14 @@
 #include <vector>
 #include <chrono>
 
+// 流式哈希上下文：只缓存不足一块的尾部，完整块直接从调用者缓冲区压缩
+struct SM3_CTX {
+    uint32_t V[8];      // 链接变量
+    uint64_t total;     // 已输入的消息字节数
+    uint8_t buf[64];    // 尚未压缩的尾部
+    size_t bufLen;
+};
+
 class SM3 {
 private:
     static const uint32_t IV[8];  // 初始向量
@@ -29,79 +37,109 @@ private:
         return x ^ leftRotate(x, 15) ^ leftRotate(x, 23);
     }
 
-    // 填充消息
-    static std::vector<uint8_t> pad(const uint8_t* data, size_t len) {
-        size_t l = len * 8;
-        size_t k = (448 - (l + 1) % 512 + 512) % 512;
-        size_t paddedLen = len + (k + 1 + 64) / 8;
+    // 压缩函数：用一个 64 字节消息块更新链接变量 V
+    static void compress(uint32_t V[8], const uint8_t* block) {
+        uint32_t W[68], W1[64];
 
-        std::vector<uint8_t> padded(paddedLen);
-        memcpy(padded.data(), data, len);
+        // 消息扩展
+        for (int j = 0; j < 16; j++) {
+            W[j] = (block[j * 4] << 24) | (block[j * 4 + 1] << 16) | (block[j * 4 + 2] << 8) | block[j * 4 + 3];
+        }
+        for (int j = 16; j < 68; j++) {
+            W[j] = P1(W[j - 16] ^ W[j - 9] ^ leftRotate(W[j - 3], 15)) ^ leftRotate(W[j - 13], 7) ^ W[j - 6];
+        }
+        for (int j = 0; j < 64; j++) {
+            W1[j] = W[j] ^ W[j + 4];
+        }
 
-        padded[len] = 0x80;
-        for (int i = 0; i < 8; i++) {
-            padded[paddedLen - 1 - i] = (uint8_t)((l >> (8 * i)) & 0xFF);
+        uint32_t A = V[0], B = V[1], C = V[2], D = V[3];
+        uint32_t E = V[4], F = V[5], G = V[6], H = V[7];
+
+        // 压缩函数
+        for (int j = 0; j < 64; j++) {
+            uint32_t SS1 = leftRotate((leftRotate(A, 12) + E + leftRotate(T[j], j)) & 0xFFFFFFFF, 7);
+            uint32_t SS2 = SS1 ^ leftRotate(A, 12);
+            uint32_t TT1 = (FF(A, B, C, j) + D + SS2 + W1[j]) & 0xFFFFFFFF;
+            uint32_t TT2 = (GG(E, F, G, j) + H + SS1 + W[j]) & 0xFFFFFFFF;
+
+            D = C;
+            C = leftRotate(B, 9);
+            B = A;
+            A = TT1;
+            H = G;
+            G = leftRotate(F, 19);
+            F = E;
+            E = P0(TT2);
         }
 
-        return padded;
+        // 更新向量
+        V[0] ^= A; V[1] ^= B; V[2] ^= C; V[3] ^= D;
+        V[4] ^= E; V[5] ^= F; V[6] ^= G; V[7] ^= H;
     }
 
 public:
-    static void hash(const uint8_t* data, size_t len, uint8_t digest[32]) {
-        uint32_t V[8];
-        memcpy(V, IV, sizeof(V));
-
-        std::vector<uint8_t> msg = pad(data, len);
-        size_t numBlocks = msg.size() / 64;
-
-        for (size_t i = 0; i < numBlocks; i++) {
-            const uint8_t* block = msg.data() + i * 64;
-            uint32_t W[68], W1[64];
-
-            // 消息扩展
-            for (int j = 0; j < 16; j++) {
-                W[j] = (block[j * 4] << 24) | (block[j * 4 + 1] << 16) | (block[j * 4 + 2] << 8) | block[j * 4 + 3];
-            }
-            for (int j = 16; j < 68; j++) {
-                W[j] = P1(W[j - 16] ^ W[j - 9] ^ leftRotate(W[j - 3], 15)) ^ leftRotate(W[j - 13], 7) ^ W[j - 6];
-            }
-            for (int j = 0; j < 64; j++) {
-                W1[j] = W[j] ^ W[j + 4];
-            }
-
-            uint32_t A = V[0], B = V[1], C = V[2], D = V[3];
-            uint32_t E = V[4], F = V[5], G = V[6], H = V[7];
-
-            // 压缩函数
-            for (int j = 0; j < 64; j++) {
-                uint32_t SS1 = leftRotate((leftRotate(A, 12) + E + leftRotate(T[j], j)) & 0xFFFFFFFF, 7);
-                uint32_t SS2 = SS1 ^ leftRotate(A, 12);
-                uint32_t TT1 = (FF(A, B, C, j) + D + SS2 + W1[j]) & 0xFFFFFFFF;
-                uint32_t TT2 = (GG(E, F, G, j) + H + SS1 + W[j]) & 0xFFFFFFFF;
-
-                D = C;
-                C = leftRotate(B, 9);
-                B = A;
-                A = TT1;
-                H = G;
-                G = leftRotate(F, 19);
-                F = E;
-                E = P0(TT2);
-            }
-
-            // 更新向量
-            V[0] ^= A; V[1] ^= B; V[2] ^= C; V[3] ^= D;
-            V[4] ^= E; V[5] ^= F; V[6] ^= G; V[7] ^= H;
+    static void init(SM3_CTX& ctx) {
+        memcpy(ctx.V, IV, sizeof(ctx.V));
+        ctx.total = 0;
+        ctx.bufLen = 0;
+    }
+
+    static void update(SM3_CTX& ctx, const uint8_t* data, size_t len) {
+        ctx.total += len;
+
+        // 先补齐上次遗留的不完整块
+        if (ctx.bufLen > 0) {
+            size_t take = 64 - ctx.bufLen;
+            if (take > len) take = len;
+            memcpy(ctx.buf + ctx.bufLen, data, take);
+            ctx.bufLen += take;
+            data += take;
+            len -= take;
+            if (ctx.bufLen < 64) return;
+            compress(ctx.V, ctx.buf);
+            ctx.bufLen = 0;
+        }
+
+        // 完整块不经拷贝直接压缩
+        for (; len >= 64; data += 64, len -= 64) {
+            compress(ctx.V, data);
+        }
+
+        memcpy(ctx.buf, data, len);
+        ctx.bufLen = len;
+    }
+
+    // 填充（0x80 + 若干 0 + 64 位消息比特长度）在栈上完成
+    static void final(SM3_CTX& ctx, uint8_t digest[32]) {
+        uint64_t l = ctx.total * 8;
+
+        ctx.buf[ctx.bufLen++] = 0x80;
+        if (ctx.bufLen > 56) {
+            memset(ctx.buf + ctx.bufLen, 0, 64 - ctx.bufLen);
+            compress(ctx.V, ctx.buf);
+            ctx.bufLen = 0;
+        }
+        memset(ctx.buf + ctx.bufLen, 0, 56 - ctx.bufLen);
+        for (int i = 0; i < 8; i++) {
+            ctx.buf[63 - i] = (uint8_t)((l >> (8 * i)) & 0xFF);
         }
+        compress(ctx.V, ctx.buf);
 
         // 输出
         for (int i = 0; i < 8; i++) {
-            digest[i * 4] = (V[i] >> 24) & 0xFF;
-            digest[i * 4 + 1] = (V[i] >> 16) & 0xFF;
-            digest[i * 4 + 2] = (V[i] >> 8) & 0xFF;
-            digest[i * 4 + 3] = V[i] & 0xFF;
+            digest[i * 4] = (ctx.V[i] >> 24) & 0xFF;
+            digest[i * 4 + 1] = (ctx.V[i] >> 16) & 0xFF;
+            digest[i * 4 + 2] = (ctx.V[i] >> 8) & 0xFF;
+            digest[i * 4 + 3] = ctx.V[i] & 0xFF;
         }
     }
+
+    static void hash(const uint8_t* data, size_t len, uint8_t digest[32]) {
+        SM3_CTX ctx;
+        init(ctx);
+        update(ctx, data, len);
+        final(ctx, digest);
+    }
 };
 
 // 初始向量
@@ -127,6 +165,7 @@ const uint32_t SM3::T[64] = {
     0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
     0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
     0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
+    0x7A879D8A, 0x7A879D8A, 0x7A879D8A, 0x7A879D8A,
 };
 
 // 打印哈希值
@@ -162,5 +201,16 @@ int main() {
     std::cout << "哈希值: ";
     printHex(digest, 32);
 
+    // 流式接口分段输入，结果应与一次性哈希一致
+    SM3_CTX ctx;
+    SM3::init(ctx);
+    for (size_t off = 0; off < dataSize; off += 1000) {
+        size_t n = dataSize - off < 1000 ? dataSize - off : 1000;
+        SM3::update(ctx, data.data() + off, n);
+    }
+    uint8_t streamDigest[32];
+    SM3::final(ctx, streamDigest);
+    std::cout << "流式分段哈希一致: " << (memcmp(digest, streamDigest, 32) == 0 ? "是" : "否") << std::endl;
+
     return 0;
 }
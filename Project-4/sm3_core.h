@@ -0,0 +1,859 @@
+// SM3 优化实现（仅头文件），供 Project-4 中的各个程序共用
+#ifndef SM3_CORE_H
+#define SM3_CORE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <algorithm>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SM3_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define SM3_ALWAYS_INLINE inline
+#endif
+
+// 流式哈希上下文：链接变量 + 已输入字节数 + 不足一块的尾部
+struct SM3_CTX {
+    uint32_t V[8];
+    uint64_t total;
+    uint8_t buf[64];
+    size_t bufLen;
+};
+
+// 公共前缀压缩一次后的中间状态：链接变量 + 前缀总字节数 + 尚未压缩的前缀尾部
+// （total % 64 字节）。之后每条后缀只需从这里继续压缩。
+struct SM3_MIDSTATE {
+    uint32_t V[8];
+    uint64_t total;
+    uint8_t tail[64];
+};
+
+// SM3_CTX / SM3_MIDSTATE 序列化长度上限："SM3S" + 版本 + 链接变量 + 总长度 + 尾部
+const size_t SM3_STATE_MAX_BYTES = 4 + 1 + 32 + 8 + 63;
+
+namespace sm3_detail {
+
+constexpr uint32_t ROTL(uint32_t x, unsigned n) {
+    return n % 32 == 0 ? x : (x << (n % 32)) | (x >> (32 - n % 32));
+}
+
+// 编译期生成 T_j <<< (j mod 32)，轮函数中不再做常量移位
+struct RotatedT {
+    uint32_t v[64];
+};
+
+constexpr RotatedT makeRotatedT() {
+    RotatedT t{};
+    for (unsigned j = 0; j < 64; ++j) {
+        t.v[j] = ROTL(j < 16 ? 0x79CC4519u : 0x7A879D8Au, j);
+    }
+    return t;
+}
+
+constexpr RotatedT TJ = makeRotatedT();
+
+SM3_ALWAYS_INLINE uint32_t P0(uint32_t x) {
+    return x ^ ROTL(x, 9) ^ ROTL(x, 17);
+}
+
+SM3_ALWAYS_INLINE uint32_t P1(uint32_t x) {
+    return x ^ ROTL(x, 15) ^ ROTL(x, 23);
+}
+
+SM3_ALWAYS_INLINE uint32_t load_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+SM3_ALWAYS_INLINE void store_be32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+// 单轮：J 为编译期常量，FF/GG 的选择和 W 的滚动下标都在编译期确定。
+// W 为 16 字的滚动窗口，第 J 轮顺带算出 W[J+4]（它占用 W[J-12] 的槽位）。
+template <int J>
+SM3_ALWAYS_INLINE void round(uint32_t& A, uint32_t& B, uint32_t& C, uint32_t& D,
+                             uint32_t& E, uint32_t& F, uint32_t& G, uint32_t& H,
+                             uint32_t W[16]) {
+    if constexpr (J >= 12) {
+        W[(J + 4) & 15] = P1(W[(J + 4) & 15] ^ W[(J + 11) & 15] ^ ROTL(W[(J + 1) & 15], 15))
+                        ^ ROTL(W[(J + 7) & 15], 7) ^ W[(J + 14) & 15];
+    }
+    uint32_t Wj = W[J & 15];
+    uint32_t W1j = Wj ^ W[(J + 4) & 15];
+
+    uint32_t A12 = ROTL(A, 12);
+    uint32_t SS1 = ROTL(A12 + E + TJ.v[J], 7);
+    uint32_t SS2 = SS1 ^ A12;
+    uint32_t TT1, TT2;
+    if constexpr (J < 16) {
+        TT1 = (A ^ B ^ C) + D + SS2 + W1j;
+        TT2 = (E ^ F ^ G) + H + SS1 + Wj;
+    } else {
+        TT1 = ((A & B) | (C & (A | B))) + D + SS2 + W1j;
+        TT2 = (((F ^ G) & E) ^ G) + H + SS1 + Wj;
+    }
+
+    D = C; C = ROTL(B, 9); B = A; A = TT1;
+    H = G; G = ROTL(F, 19); F = E; E = P0(TT2);
+}
+
+// 第 J0 + I 轮，全部展开
+template <int J0, size_t... I>
+SM3_ALWAYS_INLINE void rounds(uint32_t& A, uint32_t& B, uint32_t& C, uint32_t& D,
+                              uint32_t& E, uint32_t& F, uint32_t& G, uint32_t& H,
+                              uint32_t W[16], std::index_sequence<I...>) {
+    (round<J0 + (int)I>(A, B, C, D, E, F, G, H, W), ...);
+}
+
+// 标量压缩内核：V 依次吸收 blocks 个 64 字节块
+inline void compress_blocks_scalar(uint32_t V[8], const uint8_t* p, size_t blocks) {
+    for (; blocks > 0; --blocks, p += 64) {
+        uint32_t W[16];
+        for (int j = 0; j < 16; ++j) {
+            W[j] = load_be32(p + j * 4);
+        }
+
+        uint32_t A = V[0], B = V[1], C = V[2], D = V[3];
+        uint32_t E = V[4], F = V[5], G = V[6], H = V[7];
+
+        rounds<0>(A, B, C, D, E, F, G, H, W, std::make_index_sequence<16>());
+        rounds<16>(A, B, C, D, E, F, G, H, W, std::make_index_sequence<48>());
+
+        V[0] ^= A; V[1] ^= B; V[2] ^= C; V[3] ^= D;
+        V[4] ^= E; V[5] ^= F; V[6] ^= G; V[7] ^= H;
+    }
+}
+
+// 使用预先扩展好的 W[68] / W1[64] 的单轮，供 SIMD 扩展的内核使用。
+// Hook 在每轮开始时被调用，用来把下一块的消息扩展穿插到本块的压缩轮中。
+template <int J, class Hook>
+SM3_ALWAYS_INLINE void round_w(uint32_t& A, uint32_t& B, uint32_t& C, uint32_t& D,
+                               uint32_t& E, uint32_t& F, uint32_t& G, uint32_t& H,
+                               const uint32_t* W, const uint32_t* W1, Hook& hook) {
+    hook.template at_round<J>();
+
+    uint32_t A12 = ROTL(A, 12);
+    uint32_t SS1 = ROTL(A12 + E + TJ.v[J], 7);
+    uint32_t SS2 = SS1 ^ A12;
+    uint32_t TT1, TT2;
+    if constexpr (J < 16) {
+        TT1 = (A ^ B ^ C) + D + SS2 + W1[J];
+        TT2 = (E ^ F ^ G) + H + SS1 + W[J];
+    } else {
+        TT1 = ((A & B) | (C & (A | B))) + D + SS2 + W1[J];
+        TT2 = (((F ^ G) & E) ^ G) + H + SS1 + W[J];
+    }
+
+    D = C; C = ROTL(B, 9); B = A; A = TT1;
+    H = G; G = ROTL(F, 19); F = E; E = P0(TT2);
+}
+
+template <int J0, class Hook, size_t... I>
+SM3_ALWAYS_INLINE void rounds_w(uint32_t& A, uint32_t& B, uint32_t& C, uint32_t& D,
+                                uint32_t& E, uint32_t& F, uint32_t& G, uint32_t& H,
+                                const uint32_t* W, const uint32_t* W1, Hook& hook,
+                                std::index_sequence<I...>) {
+    (round_w<J0 + (int)I>(A, B, C, D, E, F, G, H, W, W1, hook), ...);
+}
+
+template <class Hook>
+SM3_ALWAYS_INLINE void compress_expanded(uint32_t V[8], const uint32_t* W, const uint32_t* W1, Hook& hook) {
+    uint32_t A = V[0], B = V[1], C = V[2], D = V[3];
+    uint32_t E = V[4], F = V[5], G = V[6], H = V[7];
+
+    rounds_w<0>(A, B, C, D, E, F, G, H, W, W1, hook, std::make_index_sequence<16>());
+    rounds_w<16>(A, B, C, D, E, F, G, H, W, W1, hook, std::make_index_sequence<48>());
+
+    V[0] ^= A; V[1] ^= B; V[2] ^= C; V[3] ^= D;
+    V[4] ^= E; V[5] ^= F; V[6] ^= G; V[7] ^= H;
+}
+
+struct NoHook {
+    template <int J>
+    SM3_ALWAYS_INLINE void at_round() {}
+};
+
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__))
+#define SM3_HAVE_SIMD 1
+
+// 单消息流的 SIMD 消息扩展。
+// 用 GCC 向量扩展写出与指令集无关的扩展过程，再以不同 target 属性实例化：
+// 每个 128 位通道对应一个消息块，SSE4 一次扩展 1 块，AVX2 与 AVX-512 一次扩展 2 块
+// （AVX-512 用 256 位寄存器上的 VPROLD 做循环移位；实测 4 块的 512 位版本反而更慢）。
+// 扩展只依赖消息本身，同一条消息的相邻块可以一起扩展，压缩轮仍按顺序标量执行。
+template <int N>
+struct SimdVec {
+    typedef uint32_t u32 __attribute__((vector_size(16 * N)));
+    typedef int32_t i32 __attribute__((vector_size(16 * N)));
+    typedef uint8_t u8 __attribute__((vector_size(16 * N)));
+    typedef int8_t i8 __attribute__((vector_size(16 * N)));
+};
+
+// 以下辅助函数都通过引用传递向量：它们总是内联进带 target 属性的函数，
+// 按值传递宽向量会触发（无实际影响的）-Wpsabi 警告。
+
+// 按 128 位通道的字选择：下标 0-3 取自 x，4-7 取自 y
+template <int N, int S0, int S1, int S2, int S3>
+SM3_ALWAYS_INLINE void lane_shuffle(typename SimdVec<N>::u32& r, const typename SimdVec<N>::u32& x,
+                                    const typename SimdVec<N>::u32& y) {
+    typename SimdVec<N>::i32 mask;
+    const int sel[4] = {S0, S1, S2, S3};
+    for (int l = 0; l < N; ++l) {
+        for (int i = 0; i < 4; ++i) {
+            mask[4 * l + i] = sel[i] < 4 ? 4 * l + sel[i] : 4 * N + 4 * l + sel[i] - 4;
+        }
+    }
+    r = __builtin_shuffle(x, y, mask);
+}
+
+template <int N>
+SM3_ALWAYS_INLINE void vrotl(typename SimdVec<N>::u32& r, const typename SimdVec<N>::u32& x, int n) {
+    r = (x << n) | (x >> (32 - n));
+}
+
+template <int N>
+SM3_ALWAYS_INLINE void vP1(typename SimdVec<N>::u32& r, const typename SimdVec<N>::u32& x) {
+    typename SimdVec<N>::u32 r15, r23;
+    vrotl<N>(r15, x, 15);
+    vrotl<N>(r23, x, 23);
+    r = x ^ r15 ^ r23;
+}
+
+// 读入 N 个块各自的第 q 组（4 个字），大端转换后按通道排列
+template <int N>
+SM3_ALWAYS_INLINE void load_quad(typename SimdVec<N>::u32& r, const uint8_t* p, int q) {
+    typename SimdVec<N>::i8 swap;
+    for (int i = 0; i < 16 * N; ++i) {
+        swap[i] = (i & ~3) | (3 - (i & 3));
+    }
+    typename SimdVec<N>::u8 bytes;
+    for (int l = 0; l < N; ++l) {
+        memcpy((uint8_t*)&bytes + 16 * l, p + 64 * l + 16 * q, 16);
+    }
+    bytes = __builtin_shuffle(bytes, swap);
+    memcpy(&r, &bytes, sizeof(r));
+}
+
+template <int N>
+SM3_ALWAYS_INLINE void store_quad(uint32_t (*W)[68], int j, const typename SimdVec<N>::u32& v) {
+    for (int l = 0; l < N; ++l) {
+        memcpy(&W[l][j], (const uint32_t*)&v + 4 * l, 16);
+    }
+}
+
+template <int N>
+SM3_ALWAYS_INLINE void store_quad1(uint32_t (*W1)[64], int j, const typename SimdVec<N>::u32& v) {
+    for (int l = 0; l < N; ++l) {
+        memcpy(&W1[l][j], (const uint32_t*)&v + 4 * l, 16);
+    }
+}
+
+// 扩展 N 个连续块：每步由前 16 个字算出 4 个新字，共 13 步。
+// 第 4 个新字依赖同一步的第 1 个新字 W[j]，先按 W[j] = 0 计算，
+// 再利用 P1 对异或的线性性补上 P1(W[j] <<< 15)。
+template <int N>
+struct Expander {
+    typedef typename SimdVec<N>::u32 V;
+    V v0, v1, v2, v3;
+    uint32_t (*W)[68];
+    uint32_t (*W1)[64];
+
+    SM3_ALWAYS_INLINE void begin(const uint8_t* p, uint32_t (*w)[68], uint32_t (*w1)[64]) {
+        W = w;
+        W1 = w1;
+        load_quad<N>(v0, p, 0); load_quad<N>(v1, p, 1);
+        load_quad<N>(v2, p, 2); load_quad<N>(v3, p, 3);
+
+        store_quad<N>(W, 0, v0); store_quad<N>(W, 4, v1);
+        store_quad<N>(W, 8, v2); store_quad<N>(W, 12, v3);
+        store_quad1<N>(W1, 0, v0 ^ v1);
+        store_quad1<N>(W1, 4, v1 ^ v2);
+        store_quad1<N>(W1, 8, v2 ^ v3);
+    }
+
+    template <int S>
+    SM3_ALWAYS_INLINE void step() {
+        constexpr int j = 16 + 4 * S;
+        const V zero = {};
+        V t, u, x, y;
+        lane_shuffle<N, 3, 4, 5, 6>(x, v1, v2);     // W[j-9]
+        x ^= v0;                                     // W[j-16]
+        lane_shuffle<N, 1, 2, 3, 4>(t, v3, zero);   // W[j-3]，第 4 个字暂按 0
+        vrotl<N>(u, t, 15);
+        x ^= u;
+        vP1<N>(y, x);
+        lane_shuffle<N, 3, 4, 5, 6>(t, v0, v1);     // W[j-13]
+        vrotl<N>(u, t, 7);
+        y ^= u;
+        lane_shuffle<N, 2, 3, 4, 5>(t, v2, v3);     // W[j-6]
+        y ^= t;
+        lane_shuffle<N, 0, 0, 0, 4>(t, zero, y);    // 修正第 4 个字
+        vrotl<N>(u, t, 15);
+        vP1<N>(t, u);
+        y ^= t;
+
+        store_quad<N>(W, j, y);
+        store_quad1<N>(W1, j - 4, v3 ^ y);
+        v0 = v1; v1 = v2; v2 = v3; v3 = y;
+    }
+
+    template <size_t... S>
+    SM3_ALWAYS_INLINE void steps(std::index_sequence<S...>) {
+        (step<(int)S>(), ...);
+    }
+
+    // 作为压缩轮的钩子：每 4 轮穿插一步扩展，前 52 轮内完成整组扩展
+    template <int J>
+    SM3_ALWAYS_INLINE void at_round() {
+        if constexpr (J % 4 == 0 && J / 4 < 13) {
+            step<J / 4>();
+        }
+    }
+};
+
+// 每组 N 块：第一块的压缩轮中穿插下一组的扩展（最后一组时重复扩展本组到备用缓冲区），
+// 使向量扩展与标量压缩轮重叠执行；不足一组的尾块交给标量内核。
+template <int N>
+SM3_ALWAYS_INLINE void compress_blocks_simd(uint32_t V[8], const uint8_t* p, size_t blocks) {
+    if (blocks < N) {
+        compress_blocks_scalar(V, p, blocks);
+        return;
+    }
+
+    alignas(64) uint32_t W[2][N][68];
+    alignas(64) uint32_t W1[2][N][64];
+    NoHook none;
+    int cur = 0;
+
+    Expander<N> first;
+    first.begin(p, W[0], W1[0]);
+    first.steps(std::make_index_sequence<13>());
+
+    for (; blocks >= N; blocks -= N, p += 64 * N, cur ^= 1) {
+        Expander<N> next;
+        next.begin(blocks >= 2 * N ? p + 64 * N : p, W[cur ^ 1], W1[cur ^ 1]);
+        compress_expanded(V, W[cur][0], W1[cur][0], next);
+        for (int l = 1; l < N; ++l) {
+            compress_expanded(V, W[cur][l], W1[cur][l], none);
+        }
+    }
+    compress_blocks_scalar(V, p, blocks);
+}
+
+__attribute__((target("sse4.1")))
+inline void compress_blocks_sse4(uint32_t V[8], const uint8_t* p, size_t blocks) {
+    compress_blocks_simd<1>(V, p, blocks);
+}
+
+__attribute__((target("avx2")))
+inline void compress_blocks_avx2(uint32_t V[8], const uint8_t* p, size_t blocks) {
+    compress_blocks_simd<2>(V, p, blocks);
+}
+
+__attribute__((target("avx512f,avx512vl,avx512bw")))
+inline void compress_blocks_avx512(uint32_t V[8], const uint8_t* p, size_t blocks) {
+    compress_blocks_simd<2>(V, p, blocks);
+}
+
+// 多缓冲内核：L = 4N 条互相独立的消息各占向量的一个 32 位通道，
+// 所有运算都按通道进行，与标量轮函数一一对应。
+template <int N>
+SM3_ALWAYS_INLINE void vP0(typename SimdVec<N>::u32& r, const typename SimdVec<N>::u32& x) {
+    typename SimdVec<N>::u32 r9, r17;
+    vrotl<N>(r9, x, 9);
+    vrotl<N>(r17, x, 17);
+    r = x ^ r9 ^ r17;
+}
+
+template <int J, int N>
+SM3_ALWAYS_INLINE void mb_round(typename SimdVec<N>::u32 (&S)[8], typename SimdVec<N>::u32 (&W)[16]) {
+    typedef typename SimdVec<N>::u32 V;
+    V t, u;
+    if constexpr (J >= 12) {
+        vrotl<N>(t, W[(J + 1) & 15], 15);
+        vP1<N>(u, W[(J + 4) & 15] ^ W[(J + 11) & 15] ^ t);
+        vrotl<N>(t, W[(J + 7) & 15], 7);
+        W[(J + 4) & 15] = u ^ t ^ W[(J + 14) & 15];
+    }
+    const V& Wj = W[J & 15];
+    V W1j = Wj ^ W[(J + 4) & 15];
+
+    V A12, SS1, SS2, TT1, TT2;
+    vrotl<N>(A12, S[0], 12);
+    vrotl<N>(SS1, A12 + S[4] + TJ.v[J], 7);
+    SS2 = SS1 ^ A12;
+    if constexpr (J < 16) {
+        TT1 = (S[0] ^ S[1] ^ S[2]) + S[3] + SS2 + W1j;
+        TT2 = (S[4] ^ S[5] ^ S[6]) + S[7] + SS1 + Wj;
+    } else {
+        TT1 = ((S[0] & S[1]) | (S[2] & (S[0] | S[1]))) + S[3] + SS2 + W1j;
+        TT2 = (((S[5] ^ S[6]) & S[4]) ^ S[6]) + S[7] + SS1 + Wj;
+    }
+
+    S[3] = S[2]; vrotl<N>(S[2], S[1], 9); S[1] = S[0]; S[0] = TT1;
+    S[7] = S[6]; vrotl<N>(S[6], S[5], 19); S[5] = S[4]; vP0<N>(S[4], TT2);
+}
+
+template <int N, size_t... J>
+SM3_ALWAYS_INLINE void mb_rounds(typename SimdVec<N>::u32 (&S)[8], typename SimdVec<N>::u32 (&W)[16],
+                                 std::index_sequence<J...>) {
+    (mb_round<(int)J, N>(S, W), ...);
+}
+
+// state 为 8 行 L 列的链接变量（按字转置存放），每条通道压缩 steps 个块：
+// 通道 l 的第 s 块位于 ptrs[l] + s * strides[l]（空闲通道的步长为 0）。
+template <int N>
+SM3_ALWAYS_INLINE void mb_compress(uint32_t* state, const uint8_t* const* ptrs,
+                                   const size_t* strides, size_t steps) {
+    typedef typename SimdVec<N>::u32 V;
+    constexpr int L = 4 * N;
+    V S[8];
+    memcpy(S, state, sizeof(S));
+
+    for (size_t s = 0; s < steps; ++s) {
+        // 转置：W[j] 的第 l 个通道是第 l 条消息当前块的第 j 个字
+        alignas(64) uint32_t T[16][L];
+        for (int l = 0; l < L; ++l) {
+            const uint8_t* p = ptrs[l] + s * strides[l];
+            for (int j = 0; j < 16; ++j) {
+                T[j][l] = load_be32(p + 4 * j);
+            }
+        }
+        V W[16];
+        memcpy(W, T, sizeof(W));
+
+        V S0[8];
+        memcpy(S0, S, sizeof(S0));
+        mb_rounds<N>(S, W, std::make_index_sequence<64>());
+        for (int i = 0; i < 8; ++i) {
+            S[i] ^= S0[i];
+        }
+    }
+    memcpy(state, S, sizeof(S));
+}
+
+__attribute__((target("avx2")))
+inline void mb_compress_avx2(uint32_t* state, const uint8_t* const* ptrs,
+                             const size_t* strides, size_t steps) {
+    mb_compress<2>(state, ptrs, strides, steps);
+}
+
+__attribute__((target("avx512f,avx512vl,avx512bw")))
+inline void mb_compress_avx512(uint32_t* state, const uint8_t* const* ptrs,
+                               const size_t* strides, size_t steps) {
+    mb_compress<4>(state, ptrs, strides, steps);
+}
+#endif
+
+typedef void (*MultiCompressFn)(uint32_t* state, const uint8_t* const* ptrs,
+                                const size_t* strides, size_t steps);
+
+// 多缓冲调度：消息按块数从多到少排序，相邻（长度相近的）消息同时占用各通道；
+// 一条通道的消息完成后立即换入下一条，所有通道都以最短的剩余段为步数推进。
+// IV 为起始链接变量，absorbed[m * absorbedStep] 为第 m 条消息在 IV 之前已经压缩的字节数
+// （64 的倍数，计入长度字段；absorbedStep 为 0 时所有消息相同）；
+// head 为各条消息共同的、尚未压缩的前缀尾部（不足一块）。
+// 每条消息的块流 = 首块（head + 消息开头，仅 headLen > 0 时）+ 消息中的完整块
+// （直接读调用者缓冲区）+ 1 至 2 个填充块。
+template <int L>
+inline void hash_many_lanes(MultiCompressFn kernel, const uint32_t IV[8],
+                            const uint64_t* absorbed, size_t absorbedStep,
+                            const uint8_t* head, size_t headLen,
+                            const uint8_t* const* msgs, const size_t* lens, size_t n,
+                            uint8_t* digests) {
+    struct Lane {
+        size_t msg;
+        const uint8_t* seg[3];  // 首块、消息中的完整块、尾部 + 填充
+        size_t segBlocks[3];
+        int cur;
+        const uint8_t* p;
+        size_t left;            // 当前段剩余块数
+        bool active;
+        uint8_t first[64];
+        uint8_t tail[128];
+    };
+    static const uint8_t idle[64] = {0};
+
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [lens, headLen](size_t a, size_t b) {
+        return (headLen + lens[a]) / 64 > (headLen + lens[b]) / 64;
+    });
+
+    alignas(64) uint32_t state[8][L];
+    Lane lane[L];
+    const uint8_t* ptrs[L];
+    size_t strides[L];
+    size_t next = 0;
+
+    // 进入下一个非空段，没有剩余段时返回 false
+    auto advance = [](Lane& ln) {
+        while (++ln.cur < 3) {
+            if (ln.segBlocks[ln.cur] > 0) {
+                ln.p = ln.seg[ln.cur];
+                ln.left = ln.segBlocks[ln.cur];
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto assign = [&](int l) {
+        Lane& ln = lane[l];
+        if (next == n) {
+            ln.active = false;
+            return;
+        }
+        size_t m = order[next++];
+        const uint8_t* msg = msgs[m];
+        size_t len = lens[m];
+        size_t firstBlocks = 0, full = 0, rest;
+
+        memset(ln.tail, 0, sizeof(ln.tail));
+        if (headLen + len < 64) {
+            if (headLen > 0) memcpy(ln.tail, head, headLen);
+            memcpy(ln.tail + headLen, msg, len);
+            rest = headLen + len;
+        } else {
+            if (headLen > 0) {
+                size_t skip = 64 - headLen;
+                memcpy(ln.first, head, headLen);
+                memcpy(ln.first + headLen, msg, skip);
+                firstBlocks = 1;
+                msg += skip;
+                len -= skip;
+            }
+            full = len / 64;
+            rest = len % 64;
+            memcpy(ln.tail, msg + full * 64, rest);
+        }
+
+        uint64_t bitLen = (absorbed[m * absorbedStep] + headLen + lens[m]) * 8;
+        size_t tailBlocks = rest < 56 ? 1 : 2;
+        ln.tail[rest] = 0x80;
+        store_be32(ln.tail + tailBlocks * 64 - 8, (uint32_t)(bitLen >> 32));
+        store_be32(ln.tail + tailBlocks * 64 - 4, (uint32_t)bitLen);
+
+        ln.msg = m;
+        ln.active = true;
+        ln.seg[0] = ln.first;
+        ln.segBlocks[0] = firstBlocks;
+        ln.seg[1] = msg;
+        ln.segBlocks[1] = full;
+        ln.seg[2] = ln.tail;
+        ln.segBlocks[2] = tailBlocks;
+        ln.cur = -1;
+        advance(ln);
+        for (int i = 0; i < 8; ++i) state[i][l] = IV[i];
+    };
+
+    for (int l = 0; l < L; ++l) assign(l);
+
+    for (;;) {
+        size_t steps = SIZE_MAX;
+        for (int l = 0; l < L; ++l) {
+            if (lane[l].active && lane[l].left < steps) steps = lane[l].left;
+        }
+        if (steps == SIZE_MAX) break;
+
+        for (int l = 0; l < L; ++l) {
+            ptrs[l] = lane[l].active ? lane[l].p : idle;
+            strides[l] = lane[l].active ? 64 : 0;
+        }
+        kernel(&state[0][0], ptrs, strides, steps);
+
+        for (int l = 0; l < L; ++l) {
+            Lane& ln = lane[l];
+            if (!ln.active) continue;
+            ln.p += steps * 64;
+            ln.left -= steps;
+            if (ln.left > 0 || advance(ln)) continue;
+            for (int i = 0; i < 8; ++i) store_be32(digests + ln.msg * 32 + i * 4, state[i][l]);
+            assign(l);
+        }
+    }
+}
+
+} // namespace sm3_detail
+
+// 压缩内核实现，默认在首次使用时按 CPU 支持的指令集选择
+enum class SM3_Backend { Auto, Scalar, SSE4, AVX2, AVX512 };
+
+class SM3 {
+public:
+    static constexpr uint32_t IV[8] = {
+        0x7380166F, 0x4914B2B9, 0x172442D7, 0xDA8A0600,
+        0xA96F30BC, 0x163138AA, 0xE38DEE4D, 0xB0FB0E4E
+    };
+
+    typedef void (*CompressFn)(uint32_t V[8], const uint8_t* data, size_t blocks);
+
+    // 压缩若干个完整的 64 字节块
+    static void compress_blocks(uint32_t V[8], const uint8_t* data, size_t blocks) {
+        kernel().fn(V, data, blocks);
+    }
+
+    // 指定压缩内核（用于基准测试对比），CPU 不支持时返回 false 且保持不变。
+    // 切换不是线程安全的，应在开始哈希之前调用。
+    static bool set_backend(SM3_Backend b) {
+        Kernel k = select(b);
+        if (k.fn == nullptr) return false;
+        kernel() = k;
+        return true;
+    }
+
+    static SM3_Backend backend() {
+        return kernel().backend;
+    }
+
+    static bool backend_supported(SM3_Backend b) {
+        return select(b).fn != nullptr;
+    }
+
+    static const char* backend_name(SM3_Backend b) {
+        switch (b) {
+        case SM3_Backend::Scalar: return "scalar";
+        case SM3_Backend::SSE4:   return "sse4";
+        case SM3_Backend::AVX2:   return "avx2";
+        case SM3_Backend::AVX512: return "avx512";
+        default:                  return "auto";
+        }
+    }
+
+    static void init(SM3_CTX& ctx) {
+        init(ctx, IV, 0);
+    }
+
+    // 从任意链接变量开始，absorbed 为得到该状态时已压缩的字节数（64 的倍数）
+    static void init(SM3_CTX& ctx, const uint32_t V[8], uint64_t absorbed) {
+        memcpy(ctx.V, V, sizeof(ctx.V));
+        ctx.total = absorbed;
+        ctx.bufLen = 0;
+    }
+
+    // 从公共前缀的中间状态继续
+    static void init(SM3_CTX& ctx, const SM3_MIDSTATE& ms) {
+        memcpy(ctx.V, ms.V, sizeof(ctx.V));
+        ctx.total = ms.total;
+        ctx.bufLen = (size_t)(ms.total % 64);
+        memcpy(ctx.buf, ms.tail, ctx.bufLen);
+    }
+
+    // 压缩前缀中的完整块，不足一块的部分留在 tail 中
+    static void midstate(const uint8_t* prefix, size_t len, SM3_MIDSTATE& ms) {
+        memcpy(ms.V, IV, sizeof(ms.V));
+        ms.total = len;
+        compress_blocks(ms.V, prefix, len / 64);
+        memset(ms.tail, 0, sizeof(ms.tail));
+        memcpy(ms.tail, prefix + len / 64 * 64, len % 64);
+    }
+
+    // 稳定的二进制编码（大端），返回写入的字节数，至多 SM3_STATE_MAX_BYTES。
+    // 中间状态与流式上下文使用同一种编码，可以互相导入。
+    static size_t serialize(const SM3_MIDSTATE& ms, uint8_t* out) {
+        return encode_state(ms.V, ms.total, ms.tail, out);
+    }
+
+    // 格式、版本或长度不符时返回 false
+    static bool deserialize(const uint8_t* in, size_t len, SM3_MIDSTATE& ms) {
+        SM3_MIDSTATE t = {};
+        if (!decode_state(in, len, t.V, t.total, t.tail)) return false;
+        ms = t;
+        return true;
+    }
+
+    // 导出流式上下文，用于检查点：恢复后只需继续输入新的数据
+    static size_t serialize(const SM3_CTX& ctx, uint8_t* out) {
+        return encode_state(ctx.V, ctx.total, ctx.buf, out);
+    }
+
+    static bool deserialize(const uint8_t* in, size_t len, SM3_CTX& ctx) {
+        if (!decode_state(in, len, ctx.V, ctx.total, ctx.buf)) return false;
+        ctx.bufLen = (size_t)(ctx.total % 64);
+        return true;
+    }
+
+    static void update(SM3_CTX& ctx, const uint8_t* data, size_t len) {
+        ctx.total += len;
+
+        // 先补齐上次遗留的不完整块
+        if (ctx.bufLen > 0) {
+            size_t take = 64 - ctx.bufLen;
+            if (take > len) take = len;
+            memcpy(ctx.buf + ctx.bufLen, data, take);
+            ctx.bufLen += take;
+            data += take;
+            len -= take;
+            if (ctx.bufLen < 64) return;
+            compress_blocks(ctx.V, ctx.buf, 1);
+            ctx.bufLen = 0;
+        }
+
+        // 完整块直接从调用者缓冲区压缩，不做拷贝
+        size_t blocks = len / 64;
+        if (blocks > 0) {
+            compress_blocks(ctx.V, data, blocks);
+            data += blocks * 64;
+            len -= blocks * 64;
+        }
+
+        memcpy(ctx.buf, data, len);
+        ctx.bufLen = len;
+    }
+
+    // 在栈上的尾部缓冲区内完成填充，不分配堆内存
+    static void final(SM3_CTX& ctx, uint8_t digest[32]) {
+        uint64_t bitLen = ctx.total * 8;
+
+        ctx.buf[ctx.bufLen++] = 0x80;
+        if (ctx.bufLen > 56) {
+            memset(ctx.buf + ctx.bufLen, 0, 64 - ctx.bufLen);
+            compress_blocks(ctx.V, ctx.buf, 1);
+            ctx.bufLen = 0;
+        }
+        memset(ctx.buf + ctx.bufLen, 0, 56 - ctx.bufLen);
+        sm3_detail::store_be32(ctx.buf + 56, (uint32_t)(bitLen >> 32));
+        sm3_detail::store_be32(ctx.buf + 60, (uint32_t)bitLen);
+        compress_blocks(ctx.V, ctx.buf, 1);
+
+        for (int i = 0; i < 8; ++i) {
+            sm3_detail::store_be32(digest + i * 4, ctx.V[i]);
+        }
+    }
+
+    static void hash(const uint8_t* data, size_t len, uint8_t digest[32]) {
+        SM3_CTX ctx;
+        init(ctx);
+        update(ctx, data, len);
+        final(ctx, digest);
+    }
+
+    // SM3(前缀 || suffix)，前缀已压缩在 ms 中
+    static void hash(const SM3_MIDSTATE& ms, const uint8_t* suffix, size_t len, uint8_t digest[32]) {
+        SM3_CTX ctx;
+        init(ctx, ms);
+        update(ctx, suffix, len);
+        final(ctx, digest);
+    }
+
+    // 多缓冲哈希：msgs[i]（长度 lens[i]）的摘要写入 digests + 32 * i。
+    // 当前内核为 AVX-512 时 16 条消息并行，AVX2 时 8 条，其它内核逐条计算。
+    static void hash_many(const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests) {
+        hash_many(IV, 0, msgs, lens, n, digests);
+    }
+
+    // 同上，但所有消息都从链接变量 V（之前已压缩 absorbed 字节）继续
+    static void hash_many(const uint32_t V[8], uint64_t absorbed,
+                          const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests) {
+        hash_many_from(V, &absorbed, 0, nullptr, 0, msgs, lens, n, digests);
+    }
+
+    // 所有消息从同一个链接变量 V 继续，但之前已压缩的字节数 absorbed[i] 各不相同
+    // （例如长度扩展攻击中枚举的原消息长度），只影响各自最后的长度字段
+    static void hash_many_resume(const uint32_t V[8], const uint64_t* absorbed,
+                                 const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests) {
+        hash_many_from(V, absorbed, 1, nullptr, 0, msgs, lens, n, digests);
+    }
+
+    // 批量计算 SM3(前缀 || msgs[i])，前缀已压缩在 ms 中
+    static void hash_many(const SM3_MIDSTATE& ms,
+                          const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests) {
+        size_t tailLen = (size_t)(ms.total % 64);
+        uint64_t absorbed = ms.total - tailLen;
+        hash_many_from(ms.V, &absorbed, 0, ms.tail, tailLen, msgs, lens, n, digests);
+    }
+
+private:
+    struct Kernel {
+        CompressFn fn;
+        SM3_Backend backend;
+    };
+
+    // 尾部长度由 total % 64 决定，不单独编码
+    static size_t encode_state(const uint32_t V[8], uint64_t total, const uint8_t* tail, uint8_t* out) {
+        uint8_t* p = out;
+        memcpy(p, "SM3S", 4);
+        p[4] = 1;
+        p += 5;
+        for (int i = 0; i < 8; ++i, p += 4) sm3_detail::store_be32(p, V[i]);
+        sm3_detail::store_be32(p, (uint32_t)(total >> 32));
+        sm3_detail::store_be32(p + 4, (uint32_t)total);
+        p += 8;
+        size_t tailLen = (size_t)(total % 64);
+        memcpy(p, tail, tailLen);
+        return (size_t)(p - out) + tailLen;
+    }
+
+    // 校验通过之前不修改输出参数
+    static bool decode_state(const uint8_t* in, size_t len, uint32_t V[8], uint64_t& total, uint8_t* tail) {
+        if (len < 45 || memcmp(in, "SM3S", 4) != 0 || in[4] != 1) return false;
+        const uint8_t* p = in + 45;
+        uint64_t t = ((uint64_t)sm3_detail::load_be32(in + 37) << 32) | sm3_detail::load_be32(in + 41);
+        size_t tailLen = (size_t)(t % 64);
+        if (len != 45 + tailLen) return false;
+        for (int i = 0; i < 8; ++i) V[i] = sm3_detail::load_be32(in + 5 + i * 4);
+        total = t;
+        memcpy(tail, p, tailLen);
+        return true;
+    }
+
+    static void hash_many_from(const uint32_t V[8], const uint64_t* absorbed, size_t absorbedStep,
+                               const uint8_t* head, size_t headLen,
+                               const uint8_t* const* msgs, const size_t* lens, size_t n, uint8_t* digests) {
+#ifdef SM3_HAVE_SIMD
+        switch (backend()) {
+        case SM3_Backend::AVX512:
+            sm3_detail::hash_many_lanes<16>(sm3_detail::mb_compress_avx512, V, absorbed, absorbedStep,
+                                            head, headLen, msgs, lens, n, digests);
+            return;
+        case SM3_Backend::AVX2:
+            sm3_detail::hash_many_lanes<8>(sm3_detail::mb_compress_avx2, V, absorbed, absorbedStep,
+                                           head, headLen, msgs, lens, n, digests);
+            return;
+        default:
+            break;
+        }
+#endif
+        SM3_CTX ctx;
+        for (size_t i = 0; i < n; ++i) {
+            init(ctx, V, absorbed[i * absorbedStep]);
+            if (headLen > 0) update(ctx, head, headLen);
+            update(ctx, msgs[i], lens[i]);
+            final(ctx, digests + 32 * i);
+        }
+    }
+
+    static Kernel& kernel() {
+        static Kernel k = select(SM3_Backend::Auto);
+        return k;
+    }
+
+    // Auto 按 AVX-512、AVX2、SSE4、标量的顺序选择第一个可用的内核
+    static Kernel select(SM3_Backend b) {
+#ifdef SM3_HAVE_SIMD
+        if ((b == SM3_Backend::Auto || b == SM3_Backend::AVX512) &&
+            __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+            __builtin_cpu_supports("avx512bw")) {
+            return {sm3_detail::compress_blocks_avx512, SM3_Backend::AVX512};
+        }
+        if ((b == SM3_Backend::Auto || b == SM3_Backend::AVX2) && __builtin_cpu_supports("avx2")) {
+            return {sm3_detail::compress_blocks_avx2, SM3_Backend::AVX2};
+        }
+        if ((b == SM3_Backend::Auto || b == SM3_Backend::SSE4) && __builtin_cpu_supports("sse4.1")) {
+            return {sm3_detail::compress_blocks_sse4, SM3_Backend::SSE4};
+        }
+#endif
+        if (b == SM3_Backend::Auto || b == SM3_Backend::Scalar) {
+            return {sm3_detail::compress_blocks_scalar, SM3_Backend::Scalar};
+        }
+        return {nullptr, b};
+    }
+};
+
+#endif // SM3_CORE_H
@@ -1,123 +1,98 @@
 #include <iostream>
 #include <iomanip>
+#include <cctype>
 #include <cstring>
+#include <string>
 #include <vector>
 #include <chrono>
-
-class SM3 {
-private:
-    static const uint32_t IV[8];
-    static const uint32_t T[64];
-
-    static inline uint32_t ROTL(uint32_t x, uint32_t n) {
-        return (x << n) | (x >> (32 - n));
-    }
-
-    static inline uint32_t P0(uint32_t x) {
-        return x ^ ROTL(x, 9) ^ ROTL(x, 17);
-    }
-
-    static inline uint32_t P1(uint32_t x) {
-        return x ^ ROTL(x, 15) ^ ROTL(x, 23);
+#include <random>
+#include "sm3_core.h"
+
+// 长度为 len 的消息之后的填充（0x80 + k 个 0 + 64 位长度），写入 out，返回字节数（至多 72）
+size_t glue_padding(uint64_t len, uint8_t out[72]) {
+    size_t glueLen = (len % 64 < 56 ? 64 : 128) - len % 64;
+    uint64_t bitLen = len * 8;
+    memset(out, 0, glueLen);
+    out[0] = 0x80;
+    for (int i = 0; i < 8; ++i) {
+        out[glueLen - 1 - i] = (bitLen >> (8 * i)) & 0xFF;
     }
+    return glueLen;
+}
 
-    static inline uint32_t FF(uint32_t x, uint32_t y, uint32_t z, int j) {
-        return (j < 16) ? (x ^ y ^ z) : ((x & y) | (x & z) | (y & z));
-    }
-
-    static inline uint32_t GG(uint32_t x, uint32_t y, uint32_t z, int j) {
-        return (j < 16) ? (x ^ y ^ z) : ((x & y) | ((~x) & z));
-    }
-
-public:
-    // 标准消息填充（添加 0x80 + k 个 0 + 原始长度（64位））
-    static std::vector<uint8_t> pad(const uint8_t* data, size_t len) {
-        size_t bitLen = len * 8;
-        size_t k = (448 - (bitLen + 1) % 512 + 512) % 512;
-        size_t paddedLen = len + (k + 1 + 64) / 8;
-
-        std::vector<uint8_t> res(paddedLen, 0);
-        memcpy(res.data(), data, len);
-        res[len] = 0x80;
+// 标准消息填充，仅用于构造伪造消息
+std::vector<uint8_t> pad(const uint8_t* data, size_t len) {
+    uint8_t glue[72];
+    size_t glueLen = glue_padding(len, glue);
+    std::vector<uint8_t> res(data, data + len);
+    res.insert(res.end(), glue, glue + glueLen);
+    return res;
+}
 
-        for (int i = 0; i < 8; ++i) {
-            res[paddedLen - 1 - i] = (bitLen >> (8 * i)) & 0xFF;
-        }
-        return res;
-    }
+// 从摘要中恢复链接变量 V（作为新的 IV）
+void digest_to_iv(const uint8_t digest[32], uint32_t iv[8]) {
+    for (int i = 0; i < 8; ++i)
+        iv[i] = (digest[i * 4] << 24) | (digest[i * 4 + 1] << 16) | (digest[i * 4 + 2] << 8) | digest[i * 4 + 3];
+}
 
-    // 标准哈希函数
-    static void hash(const uint8_t* data, size_t len, uint8_t digest[32]) {
-        hash_with_iv(data, len, IV, digest);
-    }
+// 以 iv 为链接变量继续哈希（用于 length extension）。
+// absorbed 为得到 iv 时已压缩的字节数，即原消息填充后的长度，会计入最后的长度字段。
+void hash_with_iv(const uint8_t* data, size_t len, const uint32_t iv[8], uint64_t absorbed, uint8_t digest[32]) {
+    SM3_CTX ctx;
+    SM3::init(ctx, iv, absorbed);
+    SM3::update(ctx, data, len);
+    SM3::final(ctx, digest);
+}
 
-    // 支持自定义初始向量的哈希函数（用于 length extension）
-    static void hash_with_iv(const uint8_t* data, size_t len, const uint32_t iv[8], uint8_t digest[32]) {
-        uint32_t V[8];
-        memcpy(V, iv, sizeof(uint32_t) * 8);
-
-        std::vector<uint8_t> msg = pad(data, len);
-        size_t blocks = msg.size() / 64;
-
-        for (size_t i = 0; i < blocks; ++i) {
-            uint32_t W[68], W1[64];
-            const uint8_t* B = msg.data() + i * 64;
-
-            for (int j = 0; j < 16; ++j)
-                W[j] = (B[j * 4] << 24) | (B[j * 4 + 1] << 16) | (B[j * 4 + 2] << 8) | B[j * 4 + 3];
-            for (int j = 16; j < 68; ++j)
-                W[j] = P1(W[j - 16] ^ W[j - 9] ^ ROTL(W[j - 3], 15)) ^ ROTL(W[j - 13], 7) ^ W[j - 6];
-            for (int j = 0; j < 64; ++j)
-                W1[j] = W[j] ^ W[j + 4];
-
-            uint32_t A = V[0], B_ = V[1], C = V[2], D = V[3];
-            uint32_t E = V[4], F = V[5], G = V[6], H = V[7];
-
-            for (int j = 0; j < 64; j += 8) {
-                for (int k = 0; k < 8; ++k) {
-                    uint32_t SS1 = ROTL((ROTL(A, 12) + E + ROTL(T[j + k], j + k)) & 0xFFFFFFFF, 7);
-                    uint32_t SS2 = SS1 ^ ROTL(A, 12);
-                    uint32_t TT1 = (FF(A, B_, C, j + k) + D + SS2 + W1[j + k]) & 0xFFFFFFFF;
-                    uint32_t TT2 = (GG(E, F, G, j + k) + H + SS1 + W[j + k]) & 0xFFFFFFFF;
-                    D = C; C = ROTL(B_, 9); B_ = A; A = TT1;
-                    H = G; G = ROTL(F, 19); F = E; E = P0(TT2);
-                }
-            }
-
-            V[0] ^= A; V[1] ^= B_; V[2] ^= C; V[3] ^= D;
-            V[4] ^= E; V[5] ^= F; V[6] ^= G; V[7] ^= H;
-        }
+// 一个候选长度的伪造结果：伪造消息为 原消息 || glue || 后缀（原消息前还有未知的密钥）
+struct Forgery {
+    size_t secretLen;
+    const uint8_t* glue;
+    size_t glueLen;
+    const uint8_t* digest;
+};
 
-        for (int i = 0; i < 8; ++i) {
-            digest[i * 4] = (V[i] >> 24) & 0xFF;
-            digest[i * 4 + 1] = (V[i] >> 16) & 0xFF;
-            digest[i * 4 + 2] = (V[i] >> 8) & 0xFF;
-            digest[i * 4 + 3] = V[i] & 0xFF;
+// 密钥长度未知时，对 secretLen ∈ [minLen, maxLen] 的每个候选值给出伪造结果，按长度递增依次交给 emit。
+// 伪造哈希只与原消息填充后的长度有关，每 64 个候选值共用一个；后缀的完整块只压缩一次，
+// 每个不同的填充后长度只剩最后 1～2 个块，成批交给多缓冲内核（各自的长度字段不同）。
+template <class Emit>
+void forge_length_range(const uint8_t digest[32], size_t dataLen, const uint8_t* suffix, size_t suffixLen,
+                        size_t minLen, size_t maxLen, Emit emit) {
+    const size_t WINDOW = 1024;  // 每批处理的不同填充后长度个数
+
+    uint32_t V[8];
+    digest_to_iv(digest, V);
+    size_t full = suffixLen / 64;
+    SM3::compress_blocks(V, suffix, full);
+    const uint8_t* tail = suffix + full * 64;
+    size_t tailLen = suffixLen % 64;
+
+    auto paddedLen = [dataLen](size_t secretLen) {
+        return (secretLen + dataLen + 8) / 64 * 64 + 64;
+    };
+
+    std::vector<uint64_t> absorbed(WINDOW);
+    std::vector<const uint8_t*> msgs(WINDOW, tail);
+    std::vector<size_t> lens(WINDOW, tailLen);
+    std::vector<uint8_t> digests(WINDOW * 32);
+    uint8_t glue[72];
+
+    for (size_t s = minLen; s <= maxLen && s >= minLen;) {
+        uint64_t first = paddedLen(s);
+        size_t n = std::min<uint64_t>(WINDOW, (paddedLen(maxLen) - first) / 64 + 1);
+        for (size_t i = 0; i < n; ++i) absorbed[i] = first + i * 64 + full * 64;
+        SM3::hash_many_resume(V, absorbed.data(), msgs.data(), lens.data(), n, digests.data());
+
+        for (; s <= maxLen && s >= minLen && paddedLen(s) < first + n * 64; ++s) {
+            Forgery f;
+            f.secretLen = s;
+            f.glueLen = glue_padding(s + dataLen, glue);
+            f.glue = glue;
+            f.digest = digests.data() + (paddedLen(s) - first) / 64 * 32;
+            emit(f);
         }
     }
-};
-
-const uint32_t SM3::IV[8] = {
-    0x7380166F, 0x4914B2B9, 0x172442D7, 0xDA8A0600,
-    0xA96F30BC, 0x163138AA, 0xE38DEE4D, 0xB0FB0E4E
-};
-
-const uint32_t SM3::T[64] = {
-    0x79CC4519,0x79CC4519,0x79CC4519,0x79CC4519,
-    0x79CC4519,0x79CC4519,0x79CC4519,0x79CC4519,
-    0x79CC4519,0x79CC4519,0x79CC4519,0x79CC4519,
-    0x79CC4519,0x79CC4519,0x79CC4519,0x79CC4519,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-};
+}
 
 void printHex(const uint8_t* d, size_t len) {
     for (size_t i = 0; i < len; i++)
@@ -136,7 +111,7 @@ void length_extension_attack() {
     printHex(digest, 32);
 
     // Step 2: 构造 padding(comment=hello)
-    std::vector<uint8_t> padded = SM3::pad(reinterpret_cast<const uint8_t*>(original.data()), original.size());
+    std::vector<uint8_t> padded = pad(reinterpret_cast<const uint8_t*>(original.data()), original.size());
 
     // Step 3: 构造伪造消息：原始消息+填充+后缀
     std::vector<uint8_t> forged(padded);
@@ -144,12 +119,11 @@ void length_extension_attack() {
 
     // Step 4: 从原哈希中恢复 V（作为新的 IV）
     uint32_t iv[8];
-    for (int i = 0; i < 8; ++i)
-        iv[i] = (digest[i * 4] << 24) | (digest[i * 4 + 1] << 16) | (digest[i * 4 + 2] << 8) | digest[i * 4 + 3];
+    digest_to_iv(digest, iv);
 
-    // Step 5: 对后缀进行 SM3 哈希（以恢复的 IV 为初始值）
+    // Step 5: 对后缀进行 SM3 哈希（以恢复的 IV 为初始值，长度字段计入填充后的原消息）
     uint8_t new_digest[32];
-    SM3::hash_with_iv(reinterpret_cast<const uint8_t*>(suffix.data()), suffix.size(), iv, new_digest);
+    hash_with_iv(reinterpret_cast<const uint8_t*>(suffix.data()), suffix.size(), iv, padded.size(), new_digest);
 
     // Step 6: 输出伪造结果
     std::cout << "伪造哈希值: ";
@@ -157,12 +131,84 @@ void length_extension_attack() {
 
     std::cout << "伪造消息内容（comment=hello + padding + &admin=true）:\n";
     for (char c : forged)
-        if (std::isprint(c)) std::cout << c;
+        if (std::isprint((unsigned char)c)) std::cout << c;
         else std::cout << "\\x" << std::hex << std::setw(2) << std::setfill('0') << (int)(uint8_t)c;
-    std::cout << std::endl;
+    std::cout << std::dec << std::endl;
+
+    // Step 7: 直接计算伪造消息的哈希，与伪造结果对比
+    uint8_t check[32];
+    SM3::hash(forged.data(), forged.size(), check);
+    std::cout << "验证 SM3(伪造消息): " << (memcmp(check, new_digest, 32) == 0 ? "一致，伪造成功" : "不一致") << std::endl;
+}
+
+// 服务器用 SM3(密钥 || 消息) 作为消息认证码，攻击者不知道密钥及其长度
+void batch_length_extension_attack() {
+    std::mt19937 rng(2024);
+    std::vector<uint8_t> secret(1337);
+    for (uint8_t& b : secret) b = (uint8_t)rng();
+    std::string data = "user=guest&comment=hello";
+    std::string suffix = "&admin=true";
+
+    auto serverMac = [&](const uint8_t* msg, size_t len, uint8_t out[32]) {
+        SM3_CTX ctx;
+        SM3::init(ctx);
+        SM3::update(ctx, secret.data(), secret.size());
+        SM3::update(ctx, msg, len);
+        SM3::final(ctx, out);
+    };
+
+    uint8_t mac[32];
+    serverMac(reinterpret_cast<const uint8_t*>(data.data()), data.size(), mac);
+
+    const size_t minLen = 1, maxLen = 4096;
+    const uint8_t* suffixPtr = reinterpret_cast<const uint8_t*>(suffix.data());
+
+    // 逐个候选长度：每次重新构造填充消息并从恢复的 IV 开始哈希
+    auto t0 = std::chrono::high_resolution_clock::now();
+    uint32_t iv[8];
+    digest_to_iv(mac, iv);
+    std::vector<uint8_t> naive((maxLen - minLen + 1) * 32);
+    for (size_t s = minLen; s <= maxLen; ++s) {
+        std::vector<uint8_t> guess(s + data.size());
+        std::vector<uint8_t> padded = pad(guess.data(), guess.size());
+        hash_with_iv(suffixPtr, suffix.size(), iv, padded.size(), naive.data() + (s - minLen) * 32);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    // 批量引擎：流式输出每个候选长度的结果，这里交给服务器验证
+    size_t candidates = 0, mismatched = 0, accepted = 0, acceptedLen = 0;
+    std::vector<uint8_t> forged;
+    double engineMs = 0;
+    forge_length_range(mac, data.size(), suffixPtr, suffix.size(), minLen, maxLen, [&](const Forgery& f) {
+        ++candidates;
+        if (memcmp(f.digest, naive.data() + (f.secretLen - minLen) * 32, 32) != 0) ++mismatched;
+
+        auto v0 = std::chrono::high_resolution_clock::now();
+        forged.assign(data.begin(), data.end());
+        forged.insert(forged.end(), f.glue, f.glue + f.glueLen);
+        forged.insert(forged.end(), suffix.begin(), suffix.end());
+        uint8_t expect[32];
+        serverMac(forged.data(), forged.size(), expect);
+        if (memcmp(expect, f.digest, 32) == 0) {
+            ++accepted;
+            acceptedLen = f.secretLen;
+        }
+        engineMs -= std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - v0).count() * 1000;
+    });
+    auto t2 = std::chrono::high_resolution_clock::now();
+    engineMs += std::chrono::duration<double>(t2 - t1).count() * 1000;
+
+    double naiveMs = std::chrono::duration<double>(t1 - t0).count() * 1000;
+    std::cout << "\n批量长度扩展：密钥长度未知，候选范围 " << minLen << "～" << maxLen << std::endl;
+    std::cout << "  逐个候选: " << naiveMs << " ms" << std::endl;
+    std::cout << "  批量引擎: " << engineMs << " ms（" << naiveMs / engineMs << " 倍，不含服务器验证）"
+              << (mismatched ? "（结果不一致！）" : "") << std::endl;
+    std::cout << "  " << candidates << " 个候选中服务器接受 " << accepted << " 个，对应密钥长度 "
+              << acceptedLen << "（实际为 " << secret.size() << "）" << std::endl;
 }
 
 int main() {
     length_extension_attack();
+    batch_length_extension_attack();
     return 0;
 }
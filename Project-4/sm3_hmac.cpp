@@ -0,0 +1,86 @@
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+#include "sm3_hmac.h"
+
+void printHex(const uint8_t* d, size_t len) {
+    for (size_t i=0;i<len;i++)
+        std::cout<<std::hex<<std::setw(2)<<std::setfill('0')<<int(d[i]);
+    std::cout<<std::dec<<std::endl;
+}
+
+// 按定义直接计算 HMAC（每次都重新哈希填充后的密钥），用于对照
+void naiveHmac(const uint8_t* key, size_t keyLen, const uint8_t* msg, size_t len, uint8_t out[32]) {
+    uint8_t k0[64]={0};
+    if (keyLen>64) SM3::hash(key, keyLen, k0);
+    else memcpy(k0, key, keyLen);
+
+    std::vector<uint8_t> in(64+len);
+    for (int i=0;i<64;i++) in[i]=k0[i]^0x36;
+    memcpy(in.data()+64, msg, len);
+    uint8_t innerDigest[32];
+    SM3::hash(in.data(), in.size(), innerDigest);
+
+    uint8_t outer[96];
+    for (int i=0;i<64;i++) outer[i]=k0[i]^0x5C;
+    memcpy(outer+64, innerDigest, 32);
+    SM3::hash(outer, sizeof(outer), out);
+}
+
+int main(){
+    std::string key="key";
+    std::string msg="The quick brown fox jumps over the lazy dog";
+    SM3_HMAC_KEY k;
+    SM3_HMAC::set_key(k, (const uint8_t*)key.data(), key.size());
+
+    uint8_t mac[32];
+    SM3_HMAC::mac(k, (const uint8_t*)msg.data(), msg.size(), mac);
+    std::cout<<"HMAC-SM3(\"key\", \""<<msg<<"\") = ";
+    printHex(mac,32);
+
+    // 流式分段输入
+    SM3_HMAC_CTX ctx;
+    SM3_HMAC::init(ctx, k);
+    for (size_t off=0; off<msg.size(); off+=7) {
+        size_t n = msg.size()-off < 7 ? msg.size()-off : 7;
+        SM3_HMAC::update(ctx, (const uint8_t*)msg.data()+off, n);
+    }
+    uint8_t streamMac[32];
+    SM3_HMAC::final(ctx, streamMac);
+    std::cout<<"流式分段 MAC 一致: "<<(memcmp(mac,streamMac,32)==0?"是":"否")<<std::endl;
+
+    // 模拟 API 请求签名：同一密钥下大量长度不一的短请求
+    const size_t requests=100000;
+    std::vector<std::vector<uint8_t>> bodies(requests);
+    std::vector<const uint8_t*> ptrs(requests);
+    std::vector<size_t> lens(requests);
+    for (size_t i=0;i<requests;i++) {
+        bodies[i].assign(64+i%200, (uint8_t)i);
+        ptrs[i]=bodies[i].data();
+        lens[i]=bodies[i].size();
+    }
+    std::vector<uint8_t> naive(requests*32), keyed(requests*32), batch(requests*32);
+
+    auto t0=std::chrono::high_resolution_clock::now();
+    for (size_t i=0;i<requests;i++)
+        naiveHmac((const uint8_t*)key.data(), key.size(), ptrs[i], lens[i], naive.data()+i*32);
+    auto t1=std::chrono::high_resolution_clock::now();
+    for (size_t i=0;i<requests;i++)
+        SM3_HMAC::mac(k, ptrs[i], lens[i], keyed.data()+i*32);
+    auto t2=std::chrono::high_resolution_clock::now();
+    SM3_HMAC::mac_many(k, ptrs.data(), lens.data(), requests, batch.data());
+    auto t3=std::chrono::high_resolution_clock::now();
+
+    double naiveMs=std::chrono::duration<double>(t1-t0).count()*1000;
+    double keyedMs=std::chrono::duration<double>(t2-t1).count()*1000;
+    double batchMs=std::chrono::duration<double>(t3-t2).count()*1000;
+    std::cout<<requests<<" 条请求（64~263 字节）:"<<std::endl;
+    std::cout<<"  每次重新处理密钥: "<<naiveMs<<" ms"<<std::endl;
+    std::cout<<"  预计算密钥状态: "<<keyedMs<<" ms（"<<naiveMs/keyedMs<<" 倍）"<<std::endl;
+    std::cout<<"  批量多缓冲: "<<batchMs<<" ms（"<<naiveMs/batchMs<<" 倍）"<<std::endl;
+    std::cout<<"结果一致: "<<(naive==keyed && naive==batch?"是":"否")<<std::endl;
+    return 0;
+}
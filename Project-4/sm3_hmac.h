@@ -0,0 +1,94 @@
+// HMAC-SM3（仅头文件），密钥对象预先保存 ipad / opad 压缩后的链接变量
+#ifndef SM3_HMAC_H
+#define SM3_HMAC_H
+
+#include "sm3_core.h"
+
+// K ^ ipad、K ^ opad 各压缩一块后的链接变量，同一密钥的所有 MAC 共用
+struct SM3_HMAC_KEY {
+    uint32_t inner[8];
+    uint32_t outer[8];
+};
+
+struct SM3_HMAC_CTX {
+    SM3_CTX inner;
+    uint32_t outer[8];
+};
+
+class SM3_HMAC {
+public:
+    static const size_t BLOCK_SIZE = 64;
+    static const size_t MAC_SIZE = 32;
+
+    // 超过一块的密钥先做一次 SM3，再补零到 64 字节
+    static void set_key(SM3_HMAC_KEY& k, const uint8_t* key, size_t keyLen) {
+        uint8_t k0[BLOCK_SIZE] = {0};
+        if (keyLen > BLOCK_SIZE) {
+            SM3::hash(key, keyLen, k0);
+        } else if (keyLen > 0) {
+            memcpy(k0, key, keyLen);
+        }
+
+        uint8_t pad[BLOCK_SIZE];
+        for (size_t i = 0; i < BLOCK_SIZE; ++i) pad[i] = k0[i] ^ 0x36;
+        memcpy(k.inner, SM3::IV, sizeof(k.inner));
+        SM3::compress_blocks(k.inner, pad, 1);
+
+        for (size_t i = 0; i < BLOCK_SIZE; ++i) pad[i] = k0[i] ^ 0x5C;
+        memcpy(k.outer, SM3::IV, sizeof(k.outer));
+        SM3::compress_blocks(k.outer, pad, 1);
+
+        memset(k0, 0, sizeof(k0));
+        memset(pad, 0, sizeof(pad));
+    }
+
+    static void init(SM3_HMAC_CTX& ctx, const SM3_HMAC_KEY& k) {
+        SM3::init(ctx.inner, k.inner, BLOCK_SIZE);
+        memcpy(ctx.outer, k.outer, sizeof(ctx.outer));
+    }
+
+    static void update(SM3_HMAC_CTX& ctx, const uint8_t* data, size_t len) {
+        SM3::update(ctx.inner, data, len);
+    }
+
+    // 外层只剩一个块：32 字节内层摘要 + 填充
+    static void final(SM3_HMAC_CTX& ctx, uint8_t out[MAC_SIZE]) {
+        uint8_t innerDigest[32];
+        SM3::final(ctx.inner, innerDigest);
+
+        SM3_CTX outer;
+        SM3::init(outer, ctx.outer, BLOCK_SIZE);
+        SM3::update(outer, innerDigest, sizeof(innerDigest));
+        SM3::final(outer, out);
+    }
+
+    static void mac(const SM3_HMAC_KEY& k, const uint8_t* data, size_t len, uint8_t out[MAC_SIZE]) {
+        SM3_HMAC_CTX ctx;
+        init(ctx, k);
+        update(ctx, data, len);
+        final(ctx, out);
+    }
+
+    // 同一密钥下的批量 MAC：msgs[i] 的结果写入 macs + 32 * i。
+    // 内层与外层各走一遍 SM3::hash_many，多缓冲内核下按通道并行。
+    static void mac_many(const SM3_HMAC_KEY& k, const uint8_t* const* msgs, const size_t* lens,
+                         size_t n, uint8_t* macs) {
+        std::vector<uint8_t> inner(n * 32);
+        SM3::hash_many(k.inner, BLOCK_SIZE, msgs, lens, n, inner.data());
+
+        std::vector<const uint8_t*> ptrs(n);
+        std::vector<size_t> innerLens(n, 32);
+        for (size_t i = 0; i < n; ++i) ptrs[i] = inner.data() + 32 * i;
+        SM3::hash_many(k.outer, BLOCK_SIZE, ptrs.data(), innerLens.data(), n, macs);
+    }
+
+    // 不缓存密钥状态的一次性接口
+    static void mac(const uint8_t* key, size_t keyLen, const uint8_t* data, size_t len,
+                    uint8_t out[MAC_SIZE]) {
+        SM3_HMAC_KEY k;
+        set_key(k, key, keyLen);
+        mac(k, data, len, out);
+    }
+};
+
+#endif // SM3_HMAC_H
@@ -0,0 +1,45 @@
+// SM2 密钥派生函数 KDF（仅头文件）：K = SM3(Z || ct) 依次拼接，ct 为从 1 开始的 32 位大端计数器
+#ifndef SM3_KDF_H
+#define SM3_KDF_H
+
+#include "sm3_core.h"
+
+// Z 只压缩一次得到中间状态，各计数器块作为 4 字节后缀成批交给多缓冲 hash_many。
+// outlen 超出计数器范围（(2^32 - 1) * 32 字节）时返回 false，不写输出。
+inline bool sm3_kdf(const uint8_t* z, size_t zlen, uint8_t* out, size_t outlen) {
+    const size_t BATCH = 256;
+    uint64_t blocks = ((uint64_t)outlen + 31) / 32;
+    if (blocks > 0xFFFFFFFFull) return false;
+
+    SM3_MIDSTATE ms;
+    SM3::midstate(z, zlen, ms);
+
+    uint8_t counters[BATCH][4];
+    const uint8_t* ptrs[BATCH];
+    size_t lens[BATCH];
+    uint8_t last[BATCH * 32];
+    for (size_t i = 0; i < BATCH; ++i) {
+        ptrs[i] = counters[i];
+        lens[i] = 4;
+    }
+
+    for (uint64_t done = 0; done < blocks;) {
+        size_t n = (size_t)std::min<uint64_t>(BATCH, blocks - done);
+        for (size_t i = 0; i < n; ++i) {
+            sm3_detail::store_be32(counters[i], (uint32_t)(done + i + 1));
+        }
+
+        // 完整的一批直接写入输出，只有末尾不足 32 字节的部分经过临时缓冲区
+        size_t offset = (size_t)done * 32;
+        if (offset + n * 32 <= outlen) {
+            SM3::hash_many(ms, ptrs, lens, n, out + offset);
+        } else {
+            SM3::hash_many(ms, ptrs, lens, n, last);
+            memcpy(out + offset, last, outlen - offset);
+        }
+        done += n;
+    }
+    return true;
+}
+
+#endif // SM3_KDF_H
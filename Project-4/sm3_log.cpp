@@ -0,0 +1,166 @@
+// 追加写日志的增量 SM3：用检查点文件保存流式上下文，重启后只哈希新增的字节
+//
+// 用法: sm3_log <日志文件> <检查点文件>
+//
+// 检查点 = 日志文件的 (dev, inode) + 已哈希部分末尾至多 4096 字节的 SM3 + 序列化的上下文（均为大端）。
+// 恢复时三者都要对得上，日志被轮转或截断后重新写到同样长度也能发现。仅支持 POSIX。
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "sm3_core.h"
+
+#ifdef _WIN32
+#error "sm3_log.cpp 目前只支持 POSIX"
+#endif
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const size_t TAIL_BYTES = 4096;
+const size_t CHECKPOINT_MAX_BYTES = 8 + 8 + 32 + SM3_STATE_MAX_BYTES;
+
+struct Checkpoint {
+    uint64_t dev;
+    uint64_t ino;
+    uint8_t tailDigest[32];
+    SM3_CTX ctx;
+};
+
+void printHex(const uint8_t* d, size_t len) {
+    for (size_t i=0;i<len;i++)
+        std::cout<<std::hex<<std::setw(2)<<std::setfill('0')<<int(d[i]);
+    std::cout<<std::dec<<std::endl;
+}
+
+void putBE64(uint8_t* p, uint64_t v) {
+    for (int i=7;i>=0;i--) { p[i]=(uint8_t)v; v>>=8; }
+}
+
+uint64_t getBE64(const uint8_t* p) {
+    uint64_t v=0;
+    for (int i=0;i<8;i++) v=(v<<8)|p[i];
+    return v;
+}
+
+bool readAt(int fd, uint8_t* buf, size_t len, uint64_t off) {
+    while (len > 0) {
+        ssize_t r = pread(fd, buf, len, (off_t)off);
+        if (r <= 0) return false;
+        buf += r; len -= (size_t)r; off += (uint64_t)r;
+    }
+    return true;
+}
+
+// 日志中 [total - TAIL_BYTES, total) 这一段（不足时从 0 开始）的 SM3
+bool tailDigest(int fd, uint64_t total, uint8_t digest[32]) {
+    size_t len = (size_t)std::min<uint64_t>(total, TAIL_BYTES);
+    uint8_t buf[TAIL_BYTES];
+    if (!readAt(fd, buf, len, total - len)) return false;
+    SM3::hash(buf, len, digest);
+    return true;
+}
+
+bool loadCheckpoint(const char* path, Checkpoint& cp) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    uint8_t buf[CHECKPOINT_MAX_BYTES + 1];
+    ssize_t got = read(fd, buf, sizeof(buf));
+    ::close(fd);
+    if (got < 8 + 8 + 32) return false;
+    cp.dev = getBE64(buf);
+    cp.ino = getBE64(buf + 8);
+    memcpy(cp.tailDigest, buf + 16, 32);
+    return SM3::deserialize(buf + 48, (size_t)got - 48, cp.ctx);
+}
+
+// 写临时文件并 fsync，再改名替换并 fsync 所在目录：任何时刻崩溃，磁盘上都是完整的旧检查点或新检查点
+bool saveCheckpoint(const char* path, const Checkpoint& cp) {
+    uint8_t buf[CHECKPOINT_MAX_BYTES];
+    putBE64(buf, cp.dev);
+    putBE64(buf + 8, cp.ino);
+    memcpy(buf + 16, cp.tailDigest, 32);
+    size_t len = 48 + SM3::serialize(cp.ctx, buf + 48);
+
+    std::string tmp = std::string(path) + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    bool ok = true;
+    for (size_t done = 0; ok && done < len;) {
+        ssize_t w = write(fd, buf + done, len - done);
+        if (w <= 0) ok = false;
+        else done += (size_t)w;
+    }
+    if (ok && fsync(fd) != 0) ok = false;
+    if (::close(fd) != 0) ok = false;
+    if (!ok || std::rename(tmp.c_str(), path) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+
+    std::string dir = path;
+    size_t slash = dir.find_last_of('/');
+    dir = slash == std::string::npos ? "." : slash == 0 ? "/" : dir.substr(0, slash);
+    int dfd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dfd < 0) return false;
+    ok = fsync(dfd) == 0;
+    ::close(dfd);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr<<"用法: "<<argv[0]<<" <日志文件> <检查点文件>"<<std::endl;
+        return 1;
+    }
+    const char* logPath = argv[1];
+    const char* statePath = argv[2];
+
+    int log = ::open(logPath, O_RDONLY);
+    struct stat st;
+    if (log < 0 || fstat(log, &st) != 0) {
+        std::cerr<<"无法打开日志文件: "<<logPath<<std::endl;
+        return 1;
+    }
+
+    Checkpoint cp;
+    uint8_t digest[32];
+    if (!loadCheckpoint(statePath, cp)) {
+        SM3::init(cp.ctx);
+    } else if (cp.dev != (uint64_t)st.st_dev || cp.ino != (uint64_t)st.st_ino
+               || cp.ctx.total > (uint64_t)st.st_size
+               || !tailDigest(log, cp.ctx.total, digest) || memcmp(digest, cp.tailDigest, 32) != 0) {
+        // 日志被截断或轮转，检查点已不对应当前文件
+        std::cerr<<"日志与检查点不符（已轮转或截断），重新开始计算"<<std::endl;
+        SM3::init(cp.ctx);
+    }
+
+    uint64_t resumeAt = cp.ctx.total;
+    std::vector<uint8_t> chunk(1 << 20);
+    for (;;) {
+        ssize_t got = pread(log, chunk.data(), chunk.size(), (off_t)cp.ctx.total);
+        if (got <= 0) break;
+        SM3::update(cp.ctx, chunk.data(), (size_t)got);
+    }
+
+    cp.dev = (uint64_t)st.st_dev;
+    cp.ino = (uint64_t)st.st_ino;
+    if (!tailDigest(log, cp.ctx.total, cp.tailDigest) || !saveCheckpoint(statePath, cp)) {
+        std::cerr<<"无法写入检查点文件: "<<statePath<<std::endl;
+        return 1;
+    }
+    ::close(log);
+
+    // 在副本上完成填充，检查点中的上下文可以继续追加
+    SM3_CTX snapshot = cp.ctx;
+    SM3::final(snapshot, digest);
+
+    std::cout<<"日志长度: "<<cp.ctx.total<<" 字节（本次新增 "<<cp.ctx.total - resumeAt<<" 字节）"<<std::endl;
+    std::cout<<"SM3: ";
+    printHex(digest, 32);
+    return 0;
+}
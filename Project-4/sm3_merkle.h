@@ -0,0 +1,515 @@
+// 基于 SM3 的 RFC 6962 Merkle 树（仅头文件）
+//
+//   MTH({})    = SM3()
+//   MTH({d})   = SM3(0x00 || d)
+//   MTH(D[n])  = SM3(0x01 || MTH(D[0:k]) || MTH(D[k:n]))，k 为小于 n 的最大的 2 的幂
+//
+// 按层存储：第 l 层只保存完整子树（覆盖 2^l 个叶子）的哈希，第 i 个节点覆盖叶子
+// [i * 2^l, (i + 1) * 2^l)，每层是一段连续数组，节点写入后不再改变。右边缘不完整的
+// 节点（每层至多一个）单独保存在 edge_ 中，它等于 RFC 6962 递归划分中对应的子树哈希；
+// 只有一个子节点的节点直接取子节点的哈希。各层数组由 SM3_MerkleStorage 提供，默认在内存中，
+// 也可以是映射到磁盘的文件（见 sm3_merkle_file.h）。
+#ifndef SM3_MERKLE_H
+#define SM3_MERKLE_H
+
+#include "sm3_core.h"
+#include "sm3_thread_pool.h"
+#include <array>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+// 完整节点的存储：每层一段连续的 32 字节节点数组，只在末尾增长
+class SM3_MerkleStorage {
+public:
+    virtual ~SM3_MerkleStorage() {}
+    // 第 l 层的节点个数，该层不存在时为 0
+    virtual size_t level_size(size_t l) const = 0;
+    virtual const uint8_t* level(size_t l) const = 0;
+    virtual uint8_t* level(size_t l) = 0;
+    // 把第 l 层设为 count 个节点（需要时创建该层），已有节点保持不变；各层的指针随之失效。
+    // 空间不足时返回 false
+    virtual bool resize(size_t l, size_t count) = 0;
+    virtual void clear() = 0;
+};
+
+// 内存中的存储，每层一个 vector
+class SM3_MerkleMemory : public SM3_MerkleStorage {
+public:
+    size_t level_size(size_t l) const override {
+        return l < levels_.size() ? levels_[l].size() / 32 : 0;
+    }
+    const uint8_t* level(size_t l) const override {
+        return levels_[l].data();
+    }
+    uint8_t* level(size_t l) override {
+        return levels_[l].data();
+    }
+    bool resize(size_t l, size_t count) override {
+        if (levels_.size() <= l) levels_.resize(l + 1);
+        levels_[l].resize(count * 32);
+        return true;
+    }
+    void clear() override {
+        levels_.clear();
+    }
+
+private:
+    std::vector<std::vector<uint8_t>> levels_;
+};
+
+// 批量验证中的一个存在性证明：leafHash 是第 index 个叶子的哈希，proof 含 count 个 32 字节兄弟节点
+struct SM3_InclusionCheck {
+    const uint8_t* leafHash;
+    size_t index;
+    size_t treeSize;
+    const uint8_t* proof;
+    size_t count;
+    const uint8_t* root;
+};
+
+class SM3_MerkleTree {
+public:
+    static const size_t HASH_SIZE = 32;
+
+    explicit SM3_MerkleTree(unsigned threads = 0)
+        : pool_(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+          owned_(new SM3_MerkleMemory), store_(owned_.get()) {
+        init();
+    }
+
+    // 使用外部存储（如已映射的文件）。存储中已有的叶子直接成为树的内容，
+    // 只补齐上次未写完的完整节点，再用 O(log n) 次哈希算出右边缘节点和根。
+    explicit SM3_MerkleTree(SM3_MerkleStorage& storage, unsigned threads = 0)
+        : pool_(threads ? threads : std::max(1u, std::thread::hardware_concurrency())), store_(&storage) {
+        init();
+    }
+
+    // 叶子哈希 SM3(0x00 || data)
+    static void leaf_hash(const uint8_t* data, size_t len, uint8_t out[HASH_SIZE]) {
+        SM3_CTX ctx;
+        SM3::init(ctx);
+        static const uint8_t tag = 0x00;
+        SM3::update(ctx, &tag, 1);
+        SM3::update(ctx, data, len);
+        SM3::final(ctx, out);
+    }
+
+    // 内部节点哈希 SM3(0x01 || left || right)
+    static void node_hash(const uint8_t left[HASH_SIZE], const uint8_t right[HASH_SIZE], uint8_t out[HASH_SIZE]) {
+        uint8_t buf[1 + 2 * HASH_SIZE];
+        buf[0] = 0x01;
+        memcpy(buf + 1, left, HASH_SIZE);
+        memcpy(buf + 1 + HASH_SIZE, right, HASH_SIZE);
+        SM3::hash(buf, sizeof(buf), out);
+    }
+
+    // 用 n 个叶子重建整棵树，存储空间不足时返回 false（此时树为空）
+    bool build(const uint8_t* const* leaves, const size_t* lens, size_t n) {
+        store_->clear();
+        size_ = 0;
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex_);
+            lru_.clear();
+            cache_.clear();
+        }
+        if (!append_many(leaves, lens, n)) {
+            update_edge();
+            return false;
+        }
+        return true;
+    }
+
+    // 在末尾追加 n 个叶子：新叶子经多缓冲 SM3 哈希，各层只补算新出现的完整节点，
+    // 再用 O(log n) 次哈希更新右边缘节点和根，共 O(n + log size) 次哈希。
+    // 存储空间不足时返回 false，树保持不变。
+    bool append_many(const uint8_t* const* leaves, const size_t* lens, size_t n) {
+        size_t old = size_;
+        if (!store_->resize(0, old + n)) return false;
+        size_ = old + n;
+        uint8_t* out = store_->level(0) + old * HASH_SIZE;
+        pool_.parallel_for((n + TASK - 1) / TASK, [&](size_t task) {
+            size_t first = task * TASK, k = std::min(TASK, n - first);
+            SM3::hash_many(leafPrefix_, leaves + first, lens + first, k, out + first * HASH_SIZE);
+        });
+        if (!build_levels(0)) {
+            truncate(old);
+            update_edge();
+            return false;
+        }
+        update_edge();
+        return true;
+    }
+
+    bool append(const uint8_t* data, size_t len) {
+        return append_many(&data, &len, 1);
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    void root(uint8_t out[HASH_SIZE]) const {
+        memcpy(out, root_, HASH_SIZE);
+    }
+
+    // 第 l 层的完整节点个数
+    size_t level_size(size_t l) const {
+        return store_->level_size(l);
+    }
+
+    // 当前树中第 l 层第 i 个节点（完整节点或右边缘节点），不存在时返回 nullptr
+    const uint8_t* node(size_t l, size_t i) const {
+        if (i < level_size(l)) return store_->level(l) + i * HASH_SIZE;
+        if (l < edgeValid_.size() && edgeValid_[l] && i == (size_ >> l)) return edge_.data() + l * HASH_SIZE;
+        return nullptr;
+    }
+
+    // 树高，即存在性证明的最大长度
+    size_t height() const {
+        size_t h = 0;
+        while (((size_t)1 << h) < size_) ++h;
+        return h;
+    }
+
+    // RFC 6962 存在性证明（审计路径）：逐层取兄弟节点 (index >> l) ^ 1，最右侧落单的节点没有兄弟，跳过。
+    // 结果自下而上写入 out（至少 height() * 32 字节），返回节点个数；index 越界时返回 0。
+    size_t inclusion_proof(size_t index, uint8_t* out) const {
+        if (index >= size_) return 0;
+        size_t count = 0;
+        for (size_t l = 0; ((size_ - 1) >> l) > 0; ++l) {
+            size_t sibling = (index >> l) ^ 1;
+            if (sibling > ((size_ - 1) >> l)) continue;
+            memcpy(out + count * HASH_SIZE, node(l, sibling), HASH_SIZE);
+            ++count;
+        }
+        return count;
+    }
+
+    // 按 RFC 9162 2.1.3.2 的方法验证存在性证明
+    static bool verify_inclusion(const uint8_t leafHash[HASH_SIZE], size_t index, size_t treeSize,
+                                 const uint8_t* proof, size_t count, const uint8_t root[HASH_SIZE]) {
+        if (index >= treeSize) return false;
+        size_t fn = index, sn = treeSize - 1;
+        uint8_t r[HASH_SIZE];
+        memcpy(r, leafHash, HASH_SIZE);
+        for (size_t i = 0; i < count; ++i) {
+            if (sn == 0) return false;
+            const uint8_t* p = proof + i * HASH_SIZE;
+            if ((fn & 1) || fn == sn) {
+                node_hash(p, r, r);
+                while (!(fn & 1) && fn != 0) {
+                    fn >>= 1;
+                    sn >>= 1;
+                }
+            } else {
+                node_hash(r, p, r);
+            }
+            fn >>= 1;
+            sn >>= 1;
+        }
+        return sn == 0 && memcmp(r, root, HASH_SIZE) == 0;
+    }
+
+    // 批量验证：所有证明按层同步推进，每一步把各证明的父节点一起交给多缓冲 SM3。
+    // ok[i] 为第 i 个证明的结果。
+    static void verify_inclusion_many(const SM3_InclusionCheck* checks, size_t n, bool* ok) {
+        struct State {
+            size_t fn, sn, step;
+            bool active;
+        };
+        static const uint8_t nodeTag = 0x01;
+        SM3_MIDSTATE nodePrefix;
+        SM3::midstate(&nodeTag, 1, nodePrefix);
+
+        std::vector<State> st(n);
+        std::vector<uint8_t> r(n * HASH_SIZE), msgs(n * 2 * HASH_SIZE), out(n * HASH_SIZE);
+        std::vector<const uint8_t*> ptrs(n);
+        std::vector<size_t> lens(n, 2 * HASH_SIZE), which(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            const SM3_InclusionCheck& c = checks[i];
+            ok[i] = false;
+            st[i].active = c.index < c.treeSize;
+            st[i].fn = c.index;
+            st[i].sn = c.treeSize - 1;
+            st[i].step = 0;
+            if (st[i].active) memcpy(r.data() + i * HASH_SIZE, c.leafHash, HASH_SIZE);
+        }
+
+        for (;;) {
+            size_t m = 0;
+            for (size_t i = 0; i < n; ++i) {
+                State& s = st[i];
+                if (!s.active) continue;
+                const SM3_InclusionCheck& c = checks[i];
+                if (s.step == c.count) {
+                    s.active = false;
+                    ok[i] = s.sn == 0 && memcmp(r.data() + i * HASH_SIZE, c.root, HASH_SIZE) == 0;
+                    continue;
+                }
+                if (s.sn == 0) {
+                    s.active = false;
+                    continue;
+                }
+                const uint8_t* p = c.proof + s.step * HASH_SIZE;
+                const uint8_t* cur = r.data() + i * HASH_SIZE;
+                bool left = (s.fn & 1) || s.fn == s.sn;
+                uint8_t* msg = msgs.data() + m * 2 * HASH_SIZE;
+                memcpy(msg, left ? p : cur, HASH_SIZE);
+                memcpy(msg + HASH_SIZE, left ? cur : p, HASH_SIZE);
+                ptrs[m] = msg;
+                which[m++] = i;
+            }
+            if (m == 0) break;
+
+            SM3::hash_many(nodePrefix, ptrs.data(), lens.data(), m, out.data());
+            for (size_t j = 0; j < m; ++j) {
+                size_t i = which[j];
+                State& s = st[i];
+                memcpy(r.data() + i * HASH_SIZE, out.data() + j * HASH_SIZE, HASH_SIZE);
+                if (s.fn == s.sn && !(s.fn & 1)) {
+                    while (!(s.fn & 1) && s.fn != 0) {
+                        s.fn >>= 1;
+                        s.sn >>= 1;
+                    }
+                }
+                s.fn >>= 1;
+                s.sn >>= 1;
+                ++s.step;
+            }
+        }
+    }
+
+    // 前 m 个叶子构成的历史树的根，m 超过当前叶子数时返回 false
+    bool root_at(size_t m, uint8_t out[HASH_SIZE]) const {
+        if (m > size_) return false;
+        if (m == 0) {
+            static const uint8_t empty = 0;
+            SM3::hash(&empty, 0, out);
+        } else {
+            subtree_hash(0, m, out);
+        }
+        return true;
+    }
+
+    // RFC 6962 2.1.2 一致性证明：大小为 m 的树是大小为 n 的树的前缀（0 < m <= n <= size()）。
+    // 证明中的节点都是完整子树或历史树中的子树，直接读取或由完整节点合并得到。
+    // 结果写入 out（至少 (height() + 1) * 32 字节），返回节点个数；参数不合法或 m == n 时返回 0。
+    size_t consistency_proof(size_t m, size_t n, uint8_t* out) const {
+        if (m == 0 || m > n || n > size_) return 0;
+        return subproof(m, 0, n, true, out);
+    }
+
+    // 按 RFC 9162 2.1.4.2 的方法验证一致性证明
+    static bool verify_consistency(size_t m, size_t n, const uint8_t firstRoot[HASH_SIZE],
+                                   const uint8_t secondRoot[HASH_SIZE], const uint8_t* proof, size_t count) {
+        if (m > n) return false;
+        if (m == n) return count == 0 && memcmp(firstRoot, secondRoot, HASH_SIZE) == 0;
+        if (m == 0) return count == 0;
+        if (count == 0) return false;
+
+        // m 为 2 的幂时第一棵树的根本身就是路径的起点，不在证明中
+        bool pow2 = (m & (m - 1)) == 0;
+        const uint8_t* first = pow2 ? firstRoot : proof;
+        size_t next = pow2 ? 0 : 1;
+
+        size_t fn = m - 1, sn = n - 1;
+        while (fn & 1) {
+            fn >>= 1;
+            sn >>= 1;
+        }
+        uint8_t fr[HASH_SIZE], sr[HASH_SIZE];
+        memcpy(fr, first, HASH_SIZE);
+        memcpy(sr, first, HASH_SIZE);
+        for (size_t i = next; i < count; ++i) {
+            if (sn == 0) return false;
+            const uint8_t* c = proof + i * HASH_SIZE;
+            if ((fn & 1) || fn == sn) {
+                node_hash(c, fr, fr);
+                node_hash(c, sr, sr);
+                while (!(fn & 1) && fn != 0) {
+                    fn >>= 1;
+                    sn >>= 1;
+                }
+            } else {
+                node_hash(sr, c, sr);
+            }
+            fn >>= 1;
+            sn >>= 1;
+        }
+        return sn == 0 && memcmp(fr, firstRoot, HASH_SIZE) == 0 && memcmp(sr, secondRoot, HASH_SIZE) == 0;
+    }
+
+private:
+    // 每个并行任务处理的叶子 / 节点数
+    static constexpr size_t TASK = 4096;
+
+    void init() {
+        static const uint8_t leafTag = 0x00, nodeTag = 0x01;
+        SM3::midstate(&leafTag, 1, leafPrefix_);
+        SM3::midstate(&nodeTag, 1, nodePrefix_);
+        size_ = store_->level_size(0);
+        if (!build_levels(0)) {
+            // 存储放不下上层节点（正常不会发生），只保留各层都完整的最长前缀
+            size_t n = size_;
+            for (size_t l = 0; level_size(l) >= 2; ++l) {
+                n = std::min(n, ((level_size(l + 1) + 1) << (l + 1)) - 1);
+            }
+            truncate(n);
+        }
+        update_edge();
+    }
+
+    // 从第 from 层开始，补齐其上各层缺少的完整节点。
+    // 上层节点数不超过第 0 层的一半，第 0 层放得下时上层也放得下；
+    // 存储仍然拒绝扩大某一层时返回 false，此时该层及以上不完整。
+    bool build_levels(size_t from) {
+        for (size_t l = from; level_size(l) >= 2; ++l) {
+            size_t have = level_size(l + 1), want = level_size(l) / 2;
+            if (have == want) continue;
+            if (!store_->resize(l + 1, want)) return false;
+
+            const uint8_t* child = store_->level(l);
+            uint8_t* parent = store_->level(l + 1);
+            size_t count = want - have;
+            pool_.parallel_for((count + TASK - 1) / TASK, [&](size_t task) {
+                const uint8_t* ptrs[TASK];
+                size_t lens[TASK];
+                size_t first = have + task * TASK, k = std::min(TASK, want - first);
+                for (size_t i = 0; i < k; ++i) {
+                    ptrs[i] = child + (first + i) * 2 * HASH_SIZE;
+                    lens[i] = 2 * HASH_SIZE;
+                }
+                SM3::hash_many(nodePrefix_, ptrs, lens, k, parent + first * HASH_SIZE);
+            });
+        }
+        return true;
+    }
+
+    // 把树截短为前 n 个叶子，各层只缩短不扩大
+    void truncate(size_t n) {
+        for (size_t l = 0; level_size(l) > 0; ++l) {
+            if (level_size(l) > (n >> l)) store_->resize(l, n >> l);
+        }
+        size_ = n;
+    }
+
+    // 重新计算右边缘的不完整节点和根，共 O(log n) 次哈希。
+    // 第 l 层的右边缘节点覆盖 [(n >> l) << l, n)，即 n 低 l 位对应的各完整子树。
+    void update_edge() {
+        size_t height = this->height();
+        edge_.assign((height + 1) * HASH_SIZE, 0);
+        edgeValid_.assign(height + 1, false);
+
+        for (size_t l = 1; l <= height; ++l) {
+            size_t low = size_ & (((size_t)1 << l) - 1);
+            if (low == 0) continue;
+            uint8_t* e = edge_.data() + l * HASH_SIZE;
+            bool childBit = (size_ >> (l - 1)) & 1;
+            size_t below = size_ & (((size_t)1 << (l - 1)) - 1);
+            if (!childBit) {
+                memcpy(e, edge_.data() + (l - 1) * HASH_SIZE, HASH_SIZE);
+            } else if (below == 0) {
+                memcpy(e, node(l - 1, (size_ >> (l - 1)) - 1), HASH_SIZE);
+            } else {
+                node_hash(node(l - 1, (size_ >> (l - 1)) - 1), edge_.data() + (l - 1) * HASH_SIZE, e);
+            }
+            edgeValid_[l] = true;
+        }
+
+        if (size_ == 0) {
+            static const uint8_t empty = 0;
+            SM3::hash(&empty, 0, root_);
+        } else {
+            memcpy(root_, node(height, 0), HASH_SIZE);
+        }
+    }
+
+    // RFC 6962 2.1.2 的 SUBPROOF(m, D[start : start + n], b)
+    size_t subproof(size_t m, size_t start, size_t n, bool b, uint8_t* out) const {
+        if (m == n) {
+            if (b) return 0;
+            subtree_hash(start, m, out);
+            return 1;
+        }
+        size_t k = 1;
+        while (k * 2 < n) k *= 2;
+        size_t count;
+        if (m <= k) {
+            count = subproof(m, start, k, b, out);
+            subtree_hash(start + k, n - k, out + count * HASH_SIZE);
+        } else {
+            count = subproof(m - k, start + k, n - k, false, out);
+            subtree_hash(start, k, out + count * HASH_SIZE);
+        }
+        return count + 1;
+    }
+
+    // 叶子 [start, start + len) 的子树哈希，start 须是 2^ceil(log2 len) 的倍数，即某棵历史树中的节点。
+    // 完整子树和当前右边缘节点直接读取；其余按 len 的二进制分解取出完整节点，自右向左合并，结果进入 LRU 缓存。
+    void subtree_hash(size_t start, size_t len, uint8_t out[HASH_SIZE]) const {
+        size_t l = 0;
+        while (((size_t)1 << l) < len) ++l;
+        if (len == ((size_t)1 << l) || start + len == size_) {
+            memcpy(out, node(l, start >> l), HASH_SIZE);
+            return;
+        }
+
+        std::pair<size_t, size_t> key(start, len);
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex_);
+            auto it = cache_.find(key);
+            if (it != cache_.end()) {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                memcpy(out, it->second->second.data(), HASH_SIZE);
+                return;
+            }
+        }
+
+        const uint8_t* parts[64];
+        size_t count = 0, pos = start;
+        for (size_t b = l; b-- > 0;) {
+            if ((len >> b) & 1) {
+                parts[count++] = node(b, pos >> b);
+                pos += (size_t)1 << b;
+            }
+        }
+        memcpy(out, parts[count - 1], HASH_SIZE);
+        for (size_t i = count - 1; i-- > 0;) node_hash(parts[i], out, out);
+
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (cache_.count(key)) return;
+        lru_.emplace_front(key, std::array<uint8_t, HASH_SIZE>());
+        memcpy(lru_.front().second.data(), out, HASH_SIZE);
+        cache_[key] = lru_.begin();
+        if (lru_.size() > CACHE_SIZE) {
+            cache_.erase(lru_.back().first);
+            lru_.pop_back();
+        }
+    }
+
+    // 历史子树哈希缓存的容量。树只追加，不在右边缘的子树哈希一经算出就不再改变。
+    static constexpr size_t CACHE_SIZE = 4096;
+
+    struct RangeHash {
+        size_t operator()(const std::pair<size_t, size_t>& r) const {
+            return (size_t)((r.first * 0x9E3779B97F4A7C15ull) ^ r.second);
+        }
+    };
+    typedef std::list<std::pair<std::pair<size_t, size_t>, std::array<uint8_t, HASH_SIZE>>> LruList;
+
+    sm3_detail::ThreadPool pool_;
+    SM3_MIDSTATE leafPrefix_, nodePrefix_;
+    std::unique_ptr<SM3_MerkleStorage> owned_;
+    SM3_MerkleStorage* store_;
+    std::vector<uint8_t> edge_;
+    std::vector<bool> edgeValid_;
+    size_t size_ = 0;
+    uint8_t root_[HASH_SIZE];
+    mutable std::mutex cacheMutex_;
+    mutable LruList lru_;
+    mutable std::unordered_map<std::pair<size_t, size_t>, LruList::iterator, RangeHash> cache_;
+};
+
+#endif // SM3_MERKLE_H
@@ -0,0 +1,190 @@
+// SM3 Merkle 树的磁盘格式（仅头文件，POSIX mmap）
+//
+// 文件 = 4096 字节的头 + 按层排列的完整节点。容量 C（叶子数，2 的幂）决定各层的位置：
+// 第 l 层最多 C >> l 个节点，从偏移 4096 + 32 * (2C - 2 * (C >> l)) 开始。
+// 头中记录容量和各层已发布的节点数（本机字节序）。追加直接写入映射的页面，但新的节点数只记在
+// 内存里，sync() 先把节点写回磁盘再发布节点数，因此崩溃后打开得到的总是上次 sync() 时的树。
+// 叶子数超过容量时文件扩大一倍，各层自上而下搬到新位置，写回后才发布新容量。
+// 右边缘节点和根不落盘，打开时用 O(log n) 次哈希算出。
+// 查询一个节点只访问它所在的页，存在性 / 一致性证明只涉及 O(log n) 个页。
+#ifndef SM3_MERKLE_FILE_H
+#define SM3_MERKLE_FILE_H
+
+#include "sm3_merkle.h"
+
+#ifdef _WIN32
+#error "sm3_merkle_file.h 目前只支持 POSIX 的 mmap"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+class SM3_MerkleFile : public SM3_MerkleStorage {
+public:
+    static const size_t HEADER_SIZE = 4096;
+    static const size_t MAX_LEVELS = 64;
+    static const size_t INITIAL_CAPACITY = (size_t)1 << 16;
+
+    SM3_MerkleFile() {}
+    SM3_MerkleFile(const SM3_MerkleFile&) = delete;
+    SM3_MerkleFile& operator=(const SM3_MerkleFile&) = delete;
+
+    ~SM3_MerkleFile() {
+        close();
+    }
+
+    // 打开已有的文件或新建一个空文件。已有文件只做映射和头部检查，不读取节点。
+    // 扩容中途崩溃留下的文件比头中的容量大，截回原大小后照常打开。
+    bool open(const char* path) {
+        close();
+        fd_ = ::open(path, O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) return false;
+        struct stat st;
+        if (fstat(fd_, &st) != 0) return fail();
+
+        if (st.st_size == 0) {
+            if (!map(INITIAL_CAPACITY, true)) return fail();
+            Header* h = header();
+            memcpy(h->magic, MAGIC, sizeof(h->magic));
+            h->version = VERSION;
+            h->capacity = INITIAL_CAPACITY;
+            memset(count_, 0, sizeof(count_));
+            return true;
+        }
+
+        Header h;
+        if ((size_t)st.st_size < HEADER_SIZE || pread(fd_, &h, sizeof(h), 0) != (ssize_t)sizeof(h)) return fail();
+        if (memcmp(h.magic, MAGIC, sizeof(h.magic)) != 0 || h.version != VERSION) return fail();
+        if (h.capacity == 0 || (h.capacity & (h.capacity - 1)) != 0 || h.capacity > ((uint64_t)1 << 48)) return fail();
+        if ((uint64_t)st.st_size < file_size(h.capacity)) return fail();
+        if ((uint64_t)st.st_size > file_size(h.capacity) && ftruncate(fd_, (off_t)file_size(h.capacity)) != 0) return fail();
+        for (size_t l = 0; l < MAX_LEVELS; ++l) {
+            if (h.count[l] > (h.capacity >> l)) return fail();
+        }
+        memcpy(count_, h.count, sizeof(count_));
+        return map(h.capacity, false) || fail();
+    }
+
+    // 关闭前先 sync()，未写回的追加不会丢失
+    void close() {
+        if (base_) sync();
+        if (base_) munmap(base_, mapped_);
+        if (fd_ >= 0) ::close(fd_);
+        base_ = nullptr;
+        mapped_ = 0;
+        fd_ = -1;
+    }
+
+    bool is_open() const {
+        return base_ != nullptr;
+    }
+
+    // 先把节点写回磁盘，再发布各层的节点数并写回头部
+    bool sync() {
+        if (!base_ || msync(base_, mapped_, MS_SYNC) != 0) return false;
+        if (memcmp(header()->count, count_, sizeof(count_)) == 0) return true;
+        memcpy(header()->count, count_, sizeof(count_));
+        return msync(base_, HEADER_SIZE, MS_SYNC) == 0;
+    }
+
+    size_t capacity() const {
+        return base_ ? header()->capacity : 0;
+    }
+
+    size_t level_size(size_t l) const override {
+        return base_ && l < MAX_LEVELS ? count_[l] : 0;
+    }
+
+    const uint8_t* level(size_t l) const override {
+        return base_ + offset(l, header()->capacity);
+    }
+
+    uint8_t* level(size_t l) override {
+        return base_ + offset(l, header()->capacity);
+    }
+
+    bool resize(size_t l, size_t count) override {
+        if (!base_ || l >= MAX_LEVELS) return false;
+        if (count > (header()->capacity >> l) && !grow(l, count)) return false;
+        count_[l] = count;
+        return true;
+    }
+
+    // 清空后节点会被覆盖，所以节点数立即发布为 0
+    void clear() override {
+        if (!base_) return;
+        memset(count_, 0, sizeof(count_));
+        memset(header()->count, 0, sizeof(header()->count));
+        msync(base_, HEADER_SIZE, MS_SYNC);
+    }
+
+private:
+    static constexpr char MAGIC[8] = {'S', 'M', '3', 'M', 'R', 'K', 'L', 'F'};
+    static const uint64_t VERSION = 1;
+
+    struct Header {
+        char magic[8];
+        uint64_t version;
+        uint64_t capacity;
+        uint64_t count[MAX_LEVELS];
+    };
+    static_assert(sizeof(Header) <= HEADER_SIZE, "header too large");
+
+    static size_t offset(size_t l, uint64_t capacity) {
+        return HEADER_SIZE + 32 * (2 * capacity - 2 * (capacity >> l));
+    }
+
+    // 容量为 C 时共 2C - 1 个节点
+    static uint64_t file_size(uint64_t capacity) {
+        return HEADER_SIZE + 32 * (2 * capacity - 1);
+    }
+
+    Header* header() const {
+        return reinterpret_cast<Header*>(base_);
+    }
+
+    bool map(uint64_t capacity, bool extend) {
+        size_t size = (size_t)file_size(capacity);
+        if (extend && ftruncate(fd_, (off_t)size) != 0) return false;
+        void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) return false;
+        base_ = static_cast<uint8_t*>(p);
+        mapped_ = size;
+        return true;
+    }
+
+    // 扩大容量直到第 l 层放得下 count 个节点。第 0 层不动，其余各层的新位置都在旧文件末尾之后，
+    // 搬动时旧布局保持完整：节点写回磁盘之后才发布新容量，中途崩溃时按旧容量打开即可。
+    bool grow(size_t l, size_t count) {
+        uint64_t oldCap = header()->capacity, newCap = oldCap;
+        while ((newCap >> l) < count) newCap *= 2;
+
+        munmap(base_, mapped_);
+        base_ = nullptr;
+        if (!map(newCap, true)) {
+            map(oldCap, true);
+            return false;
+        }
+        for (size_t i = MAX_LEVELS; i-- > 0;) {
+            if (count_[i] == 0) continue;
+            memmove(base_ + offset(i, newCap), base_ + offset(i, oldCap), count_[i] * 32);
+        }
+        if (msync(base_, mapped_, MS_SYNC) != 0) return false;
+        header()->capacity = newCap;
+        return msync(base_, HEADER_SIZE, MS_SYNC) == 0;
+    }
+
+    bool fail() {
+        close();
+        return false;
+    }
+
+    int fd_ = -1;
+    uint8_t* base_ = nullptr;
+    uint64_t count_[MAX_LEVELS] = {};   // 各层当前的节点数，sync() 时发布到头部
+    size_t mapped_ = 0;
+};
+
+#endif // SM3_MERKLE_FILE_H
@@ -3,120 +3,7 @@
 #include <cstring>
 #include <vector>
 #include <chrono>
-
-class SM3 {
-private:
-    static const uint32_t IV[8];
-    static const uint32_t T[64];
-
-    static inline uint32_t ROTL(uint32_t x, uint32_t n) {
-        return (x << n) | (x >> (32 - n));
-    }
-
-    static inline uint32_t P0(uint32_t x) {
-        return x ^ ROTL(x, 9) ^ ROTL(x, 17);
-    }
-
-    static inline uint32_t P1(uint32_t x) {
-        return x ^ ROTL(x, 15) ^ ROTL(x, 23);
-    }
-
-    static inline uint32_t FF(uint32_t x, uint32_t y, uint32_t z, int j) {
-        return (j < 16) ? (x ^ y ^ z) : ((x & y) | (x & z) | (y & z));
-    }
-
-    static inline uint32_t GG(uint32_t x, uint32_t y, uint32_t z, int j) {
-        return (j < 16) ? (x ^ y ^ z) : ((x & y) | ((~x) & z));
-    }
-
-    static std::vector<uint8_t> pad(const uint8_t* data, size_t len) {
-        size_t bitLen = len * 8;
-        size_t k = (448 - (bitLen + 1) % 512 + 512) % 512;
-        size_t paddedLen = len + (k + 1 + 64) / 8;
- 
-        std::vector<uint8_t> res(paddedLen, 0);
-        memcpy(res.data(), data, len);
-        res[len] = 0x80;
-
-        for (int i = 0; i < 8; ++i) {
-            res[paddedLen - 1 - i] = (bitLen >> (8 * i)) & 0xFF;
-        }
-        return res;
-    }
-
-public:
-    static void hash(const uint8_t* data, size_t len, uint8_t digest[32]) {
-        uint32_t V[8];
-        memcpy(V, IV, sizeof(V));
-
-        std::vector<uint8_t> msg = pad(data, len);
-        size_t blocks = msg.size() / 64;
-
-        for (size_t i = 0; i < blocks; ++i) {
-            uint32_t W[68], W1[64];
-            const uint8_t* B = msg.data() + i * 64;
-
-            // 消息扩展合并
-            for (int j = 0; j < 16; ++j) {
-                W[j] = (B[j*4] << 24) | (B[j*4+1] << 16) | (B[j*4+2] << 8) | B[j*4+3];
-            }
-            for (int j = 16; j < 68; ++j) {
-                W[j] = P1(W[j-16] ^ W[j-9] ^ ROTL(W[j-3],15)) ^ ROTL(W[j-13],7) ^ W[j-6];
-            }
-            for (int j = 0; j < 64; ++j) {
-                W1[j] = W[j] ^ W[j+4];
-            }
-
-            uint32_t A=V[0], B_=V[1], C=V[2], D=V[3];
-            uint32_t E=V[4], F=V[5], G=V[6], H=V[7];
-
-            // 循环展开，每次处理8轮
-            for (int j = 0; j < 64; j+=8) {
-                for (int k = 0; k < 8; ++k) {
-                    uint32_t SS1 = ROTL((ROTL(A,12) + E + ROTL(T[j+k], j+k)) & 0xFFFFFFFF, 7);
-                    uint32_t SS2 = SS1 ^ ROTL(A,12);
-                    uint32_t TT1 = (FF(A,B_,C,j+k) + D + SS2 + W1[j+k]) & 0xFFFFFFFF;
-                    uint32_t TT2 = (GG(E,F,G,j+k) + H + SS1 + W[j+k]) & 0xFFFFFFFF;
-                    D=C; C=ROTL(B_,9); B_=A; A=TT1;
-                    H=G; G=ROTL(F,19); F=E; E=P0(TT2);
-                }
-            }
-
-            V[0]^=A; V[1]^=B_; V[2]^=C; V[3]^=D;
-            V[4]^=E; V[5]^=F; V[6]^=G; V[7]^=H;
-        }
-
-        for (int i=0;i<8;i++) {
-            digest[i*4]=(V[i]>>24)&0xFF;
-            digest[i*4+1]=(V[i]>>16)&0xFF;
-            digest[i*4+2]=(V[i]>>8)&0xFF;
-            digest[i*4+3]=V[i]&0xFF;
-        }
-    }
-};
-
-const uint32_t SM3::IV[8] = {
-    0x7380166F,0x4914B2B9,0x172442D7,0xDA8A0600,
-    0xA96F30BC,0x163138AA,0xE38DEE4D,0xB0FB0E4E
-};
-
-const uint32_t SM3::T[64] = {
-    0x79CC4519,0x79CC4519,0x79CC4519,0x79CC4519,
-    0x79CC4519,0x79CC4519,0x79CC4519,0x79CC4519,
-    0x79CC4519,0x79CC4519,0x79CC4519,0x79CC4519,
-    0x79CC4519,0x79CC4519,0x79CC4519,0x79CC4519,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-    0x7A879D8A,0x7A879D8A,0x7A879D8A,0x7A879D8A,
-};
+#include "sm3_core.h"
 
 void printHex(const uint8_t* d, size_t len) {
     for (size_t i=0;i<len;i++)
@@ -141,5 +28,94 @@ int main(){
     std::cout<<"SM3 哈希耗时: "<<ms<<" ms"<<std::endl;
     std::cout<<"哈希值: ";
     printHex(digest,32);
+
+    // 流式接口分段输入，结果应与一次性哈希一致
+    SM3_CTX ctx;
+    SM3::init(ctx);
+    for (size_t off=0; off<dataSize; off+=1000) {
+        size_t n = dataSize-off < 1000 ? dataSize-off : 1000;
+        SM3::update(ctx, data.data()+off, n);
+    }
+    uint8_t streamDigest[32];
+    SM3::final(ctx, streamDigest);
+    std::cout<<"流式分段哈希一致: "<<(memcmp(digest,streamDigest,32)==0?"是":"否")<<std::endl;
+
+    // 各压缩内核对比（默认内核在运行时按 CPU 指令集选择）
+    SM3_Backend defaultBackend = SM3::backend();
+    std::cout<<"默认压缩内核: "<<SM3::backend_name(defaultBackend)<<std::endl;
+    for (SM3_Backend b : {SM3_Backend::Scalar, SM3_Backend::SSE4, SM3_Backend::AVX2, SM3_Backend::AVX512}) {
+        if (!SM3::set_backend(b)) {
+            std::cout<<"  "<<SM3::backend_name(b)<<": 不支持"<<std::endl;
+            continue;
+        }
+        uint8_t d[32];
+        SM3::hash(data.data(), data.size(), d);
+        auto t0=std::chrono::high_resolution_clock::now();
+        SM3::hash(data.data(), data.size(), d);
+        auto t1=std::chrono::high_resolution_clock::now();
+        std::cout<<"  "<<SM3::backend_name(b)<<": "
+                 <<std::chrono::duration<double>(t1-t0).count()*1000<<" ms"
+                 <<(memcmp(d,digest,32)==0?"":"（结果不一致！）")<<std::endl;
+    }
+    SM3::set_backend(defaultBackend);
+
+    // 多缓冲：大量互相独立的短消息（如 Merkle 叶子）
+    const size_t records=200000, recordLen=64;
+    std::vector<uint8_t> recordData(records*recordLen, 0x5A);
+    std::vector<const uint8_t*> ptrs(records);
+    std::vector<size_t> lens(records, recordLen);
+    for (size_t i=0;i<records;i++) ptrs[i]=recordData.data()+i*recordLen;
+    std::vector<uint8_t> one(records*32), many(records*32);
+
+    auto t0=std::chrono::high_resolution_clock::now();
+    for (size_t i=0;i<records;i++) SM3::hash(ptrs[i], lens[i], one.data()+i*32);
+    auto t1=std::chrono::high_resolution_clock::now();
+    SM3::hash_many(ptrs.data(), lens.data(), records, many.data());
+    auto t2=std::chrono::high_resolution_clock::now();
+
+    double oneMs=std::chrono::duration<double>(t1-t0).count()*1000;
+    double manyMs=std::chrono::duration<double>(t2-t1).count()*1000;
+    std::cout<<records<<" 条 "<<recordLen<<" 字节消息:"<<std::endl;
+    std::cout<<"  逐条哈希: "<<oneMs<<" ms"<<std::endl;
+    std::cout<<"  多缓冲哈希: "<<manyMs<<" ms（"<<oneMs/manyMs<<" 倍）"
+             <<(one==many?"":"（结果不一致！）")<<std::endl;
+
+    // 公共前缀：1000 字节的协议头 + 各不相同的 64 字节正文
+    const size_t headerLen=1000, bodies=50000, bodyLen=64;
+    std::vector<uint8_t> header(headerLen, 0x3C), bodyData(bodies*bodyLen);
+    for (size_t i=0;i<bodyData.size();i++) bodyData[i]=(uint8_t)(i*131);
+    std::vector<const uint8_t*> bodyPtrs(bodies);
+    std::vector<size_t> bodyLens(bodies, bodyLen);
+    for (size_t i=0;i<bodies;i++) bodyPtrs[i]=bodyData.data()+i*bodyLen;
+    std::vector<uint8_t> full(bodies*32), fromMid(bodies*32), fromMidMany(bodies*32);
+
+    t0=std::chrono::high_resolution_clock::now();
+    std::vector<uint8_t> joined(header);
+    joined.resize(headerLen+bodyLen);
+    for (size_t i=0;i<bodies;i++) {
+        memcpy(joined.data()+headerLen, bodyPtrs[i], bodyLen);
+        SM3::hash(joined.data(), joined.size(), full.data()+i*32);
+    }
+    t1=std::chrono::high_resolution_clock::now();
+
+    // 中间状态经过一次序列化往返，模拟从缓存中取出
+    SM3_MIDSTATE mid, cached;
+    SM3::midstate(header.data(), headerLen, mid);
+    uint8_t encoded[SM3_STATE_MAX_BYTES];
+    size_t encodedLen=SM3::serialize(mid, encoded);
+    bool loaded=SM3::deserialize(encoded, encodedLen, cached);
+    for (size_t i=0;i<bodies;i++) SM3::hash(cached, bodyPtrs[i], bodyLen, fromMid.data()+i*32);
+    t2=std::chrono::high_resolution_clock::now();
+    SM3::hash_many(cached, bodyPtrs.data(), bodyLens.data(), bodies, fromMidMany.data());
+    auto t3=std::chrono::high_resolution_clock::now();
+
+    double fullMs=std::chrono::duration<double>(t1-t0).count()*1000;
+    double midMs=std::chrono::duration<double>(t2-t1).count()*1000;
+    double midManyMs=std::chrono::duration<double>(t3-t2).count()*1000;
+    std::cout<<bodies<<" 条消息共享 "<<headerLen<<" 字节前缀（中间状态编码 "<<encodedLen<<" 字节）:"<<std::endl;
+    std::cout<<"  每条完整哈希: "<<fullMs<<" ms"<<std::endl;
+    std::cout<<"  从中间状态继续: "<<midMs<<" ms（"<<fullMs/midMs<<" 倍）"<<std::endl;
+    std::cout<<"  中间状态 + 多缓冲: "<<midManyMs<<" ms（"<<fullMs/midManyMs<<" 倍）"
+             <<(loaded && full==fromMid && full==fromMidMany?"":"（结果不一致！）")<<std::endl;
     return 0;
 }
@@ -0,0 +1,110 @@
+// 基于 SM3 的稀疏 Merkle 树演示：存在性与不存在性证明
+//
+// 用法: sm3_smt [键数]，默认 100000
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include "sm3_smt.h"
+
+void printHex(const uint8_t* d, size_t len) {
+    for (size_t i=0;i<len;i++)
+        std::cout<<std::hex<<std::setw(2)<<std::setfill('0')<<int(d[i]);
+    std::cout<<std::dec<<std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    if (n == 0) n = 1;
+
+    // 键为 SM3("key-i")，值为 "value-i"
+    std::vector<uint8_t> keys(n*32);
+    std::vector<std::string> values(n);
+    std::vector<const uint8_t*> keyPtrs(n), valuePtrs(n);
+    std::vector<size_t> lens(n);
+    for (size_t i=0;i<n;i++) {
+        std::string k = "key-" + std::to_string(i);
+        SM3::hash((const uint8_t*)k.data(), k.size(), keys.data()+i*32);
+        values[i] = "value-" + std::to_string(i);
+        keyPtrs[i] = keys.data()+i*32;
+        valuePtrs[i] = (const uint8_t*)values[i].data();
+        lens[i] = values[i].size();
+    }
+
+    SM3_SparseMerkleTree tree;
+    auto t0=std::chrono::high_resolution_clock::now();
+    tree.insert_many(keyPtrs.data(), valuePtrs.data(), lens.data(), n);
+    auto t1=std::chrono::high_resolution_clock::now();
+    uint8_t root[32];
+    tree.root(root);
+    std::cout<<"键数: "<<n<<std::endl;
+    std::cout<<"稀疏 Merkle 根: ";
+    printHex(root, 32);
+    std::cout<<"  批量写入: "<<std::chrono::duration<double>(t1-t0).count()*1000<<" ms"<<std::endl;
+
+    // 乱序分批写入、删除再写回，根应与一次写入相同
+    std::vector<size_t> order(n);
+    for (size_t i=0;i<n;i++) order[i]=i;
+    std::mt19937 rng(2024);
+    std::shuffle(order.begin(), order.end(), rng);
+    SM3_SparseMerkleTree other;
+    for (size_t first=0; first<n; first+=1000) {
+        size_t k = std::min<size_t>(1000, n-first);
+        std::vector<const uint8_t*> kp(k), vp(k);
+        std::vector<size_t> lp(k);
+        for (size_t j=0;j<k;j++) {
+            kp[j]=keyPtrs[order[first+j]];
+            vp[j]=valuePtrs[order[first+j]];
+            lp[j]=lens[order[first+j]];
+        }
+        other.insert_many(kp.data(), vp.data(), lp.data(), k);
+    }
+    size_t removed = std::min<size_t>(n, 100);
+    for (size_t j=0;j<removed;j++) other.erase(keyPtrs[order[j]]);
+    for (size_t j=0;j<removed;j++) other.insert(keyPtrs[order[j]], valuePtrs[order[j]], lens[order[j]]);
+    uint8_t otherRoot[32];
+    other.root(otherRoot);
+    std::cout<<"  乱序分批写入并删除、写回 "<<removed<<" 个键后的根: "
+             <<(memcmp(root, otherRoot, 32)==0?"一致":"不一致")<<std::endl;
+
+    // 对已有的键证明存在，对不存在的键证明不存在
+    const size_t PROOFS = 1000;
+    SM3_SparseProof proof;
+    size_t depthSum=0, siblingSum=0, okIn=0, okOut=0, rejected=0;
+    double verifyMs=0;
+    for (size_t j=0;j<PROOFS;j++) {
+        size_t i = order[j % n];
+        uint8_t valueHash[32];
+        SM3::hash(valuePtrs[i], lens[i], valueHash);
+        tree.prove(keyPtrs[i], proof);
+        depthSum += proof.depth;
+        siblingSum += proof.siblings.size()/32;
+        auto v0=std::chrono::high_resolution_clock::now();
+        okIn += SM3_SparseMerkleTree::verify(root, keyPtrs[i], valueHash, proof);
+        verifyMs += std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-v0).count()*1000;
+        rejected += !SM3_SparseMerkleTree::verify(root, keyPtrs[i], nullptr, proof);
+
+        std::string absent = "absent-" + std::to_string(j);
+        uint8_t key[32];
+        SM3::hash((const uint8_t*)absent.data(), absent.size(), key);
+        tree.prove(key, proof);
+        depthSum += proof.depth;
+        siblingSum += proof.siblings.size()/32;
+        v0=std::chrono::high_resolution_clock::now();
+        okOut += SM3_SparseMerkleTree::verify(root, key, nullptr, proof);
+        verifyMs += std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-v0).count()*1000;
+        rejected += !SM3_SparseMerkleTree::verify(root, key, valueHash, proof);
+    }
+    std::cout<<"证明 "<<PROOFS<<" 个存在的键和 "<<PROOFS<<" 个不存在的键:"<<std::endl;
+    std::cout<<"  存在性验证通过 "<<okIn<<" 个，不存在性验证通过 "<<okOut<<" 个，反向声明被拒绝 "
+             <<rejected<<" 个"<<std::endl;
+    std::cout<<"  平均路径深度 "<<double(depthSum)/(2*PROOFS)<<"，平均非空兄弟 "<<double(siblingSum)/(2*PROOFS)
+             <<" 个（完整展开需 256 层）"<<std::endl;
+    std::cout<<"  平均验证耗时: "<<verifyMs*1000/(2*PROOFS)<<" us"<<std::endl;
+    return 0;
+}
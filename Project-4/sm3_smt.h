@@ -0,0 +1,314 @@
+// 基于 SM3 的稀疏 Merkle 树（仅头文件），用于证明某个键存在或不存在
+//
+// 键为 32 字节，按位（高位在前）决定 256 层路径上的左右，值只保存其哈希 SM3(value)。
+//   空子树      E(0) = 0^32，E(h) = SM3(0x01 || E(h-1) || E(h-1))，高度 0～256 预先算好
+//   单叶子子树  SM3(0x00 || key || SM3(value))，无论高度多少都直接取叶子哈希，不再向下展开
+//   其余节点    SM3(0x01 || 左 || 右)
+// 叶子的捷径使树的实际深度约为 log2 n，存在与不存在的证明都只需 O(log n) 次哈希。
+#ifndef SM3_SMT_H
+#define SM3_SMT_H
+
+#include "sm3_core.h"
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+// 证明从根到终止节点的路径：终止节点是一个叶子（可能是别的键）或一棵空子树
+struct SM3_SparseProof {
+    size_t depth = 0;                  // 终止节点的深度
+    uint8_t bitmap[32] = {};           // 第 d 位（高位在前）为 1 表示深度 d + 1 处的兄弟非空
+    std::vector<uint8_t> siblings;     // 非空兄弟的哈希，自上而下
+    bool hasLeaf = false;              // 终止节点为叶子时给出其键和值哈希
+    uint8_t leafKey[32] = {};
+    uint8_t leafValue[32] = {};
+};
+
+class SM3_SparseMerkleTree {
+public:
+    static const size_t HASH_SIZE = 32;
+    static const size_t DEPTH = 256;
+    static const size_t SMALL_BATCH = 16;   // 不超过此数的一批键原地插入，更大的批与已有叶子归并
+
+    SM3_SparseMerkleTree() {
+        static const uint8_t leafTag = 0x00, nodeTag = 0x01;
+        SM3::midstate(&leafTag, 1, leafPrefix_);
+        SM3::midstate(&nodeTag, 1, nodePrefix_);
+        memcpy(root_, empty(DEPTH), HASH_SIZE);
+    }
+
+    // 高度为 h 的空子树的哈希
+    static const uint8_t* empty(size_t h) {
+        static const std::vector<uint8_t> table = [] {
+            std::vector<uint8_t> t((DEPTH + 1) * HASH_SIZE, 0);
+            for (size_t h = 1; h <= DEPTH; ++h)
+                node_hash(t.data() + (h - 1) * HASH_SIZE, t.data() + (h - 1) * HASH_SIZE, t.data() + h * HASH_SIZE);
+            return t;
+        }();
+        return table.data() + h * HASH_SIZE;
+    }
+
+    // 叶子哈希 SM3(0x00 || key || valueHash)
+    static void leaf_hash(const uint8_t key[HASH_SIZE], const uint8_t valueHash[HASH_SIZE], uint8_t out[HASH_SIZE]) {
+        uint8_t buf[1 + 2 * HASH_SIZE];
+        buf[0] = 0x00;
+        memcpy(buf + 1, key, HASH_SIZE);
+        memcpy(buf + 1 + HASH_SIZE, valueHash, HASH_SIZE);
+        SM3::hash(buf, sizeof(buf), out);
+    }
+
+    // 内部节点哈希 SM3(0x01 || left || right)
+    static void node_hash(const uint8_t left[HASH_SIZE], const uint8_t right[HASH_SIZE], uint8_t out[HASH_SIZE]) {
+        uint8_t buf[1 + 2 * HASH_SIZE];
+        buf[0] = 0x01;
+        memcpy(buf + 1, left, HASH_SIZE);
+        memcpy(buf + 1 + HASH_SIZE, right, HASH_SIZE);
+        SM3::hash(buf, sizeof(buf), out);
+    }
+
+    // 写入 n 个键值对（已存在的键覆盖其值，同一批中重复的键以最后一个为准）。
+    // 值哈希和叶子哈希经多缓冲 SM3 成批计算，之后只重算新键路径上的节点。
+    void insert_many(const uint8_t* const* keys, const uint8_t* const* values, const size_t* lens, size_t n) {
+        std::vector<Entry> batch(n);
+        std::vector<uint8_t> valueHashes(n * HASH_SIZE), msgs(n * 2 * HASH_SIZE);
+        std::vector<const uint8_t*> ptrs(n);
+        std::vector<size_t> msgLens(n, 2 * HASH_SIZE);
+        SM3::hash_many(values, lens, n, valueHashes.data());
+        for (size_t i = 0; i < n; ++i) {
+            memcpy(msgs.data() + i * 2 * HASH_SIZE, keys[i], HASH_SIZE);
+            memcpy(msgs.data() + i * 2 * HASH_SIZE + HASH_SIZE, valueHashes.data() + i * HASH_SIZE, HASH_SIZE);
+            ptrs[i] = msgs.data() + i * 2 * HASH_SIZE;
+        }
+        std::vector<uint8_t> leaves(n * HASH_SIZE);
+        SM3::hash_many(leafPrefix_, ptrs.data(), msgLens.data(), n, leaves.data());
+        for (size_t i = 0; i < n; ++i) {
+            memcpy(batch[i].key, keys[i], HASH_SIZE);
+            memcpy(batch[i].value, valueHashes.data() + i * HASH_SIZE, HASH_SIZE);
+            memcpy(batch[i].leaf, leaves.data() + i * HASH_SIZE, HASH_SIZE);
+        }
+
+        // 稳定排序后同键只保留最后一个，再写入已有叶子
+        std::stable_sort(batch.begin(), batch.end(), key_less);
+        size_t m = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (m > 0 && !key_less(batch[m - 1], batch[i])) batch[m - 1] = batch[i];
+            else batch[m++] = batch[i];
+        }
+        batch.resize(m);
+
+        if (m <= SMALL_BATCH) {
+            // 少量键逐个二分定位后原地覆盖或插入，不复制整个叶子数组
+            for (size_t i = 0; i < m; ++i) {
+                auto it = std::lower_bound(entries_.begin(), entries_.end(), batch[i], key_less);
+                if (it != entries_.end() && !key_less(batch[i], *it)) *it = batch[i];
+                else entries_.insert(it, batch[i]);
+            }
+        } else {
+            std::vector<Entry> merged;
+            merged.reserve(entries_.size() + m);
+            size_t a = 0, b = 0;
+            while (a < entries_.size() || b < m) {
+                if (b == m || (a < entries_.size() && key_less(entries_[a], batch[b]))) {
+                    merged.push_back(entries_[a++]);
+                } else {
+                    if (a < entries_.size() && !key_less(batch[b], entries_[a])) ++a;
+                    merged.push_back(batch[b++]);
+                }
+            }
+            entries_.swap(merged);
+        }
+
+        std::vector<Key> dirty(m);
+        for (size_t i = 0; i < m; ++i) memcpy(dirty[i].data(), batch[i].key, HASH_SIZE);
+        refresh(dirty);
+    }
+
+    void insert(const uint8_t key[HASH_SIZE], const uint8_t* value, size_t len) {
+        insert_many(&key, &value, &len, 1);
+    }
+
+    // 删除一个键，键不存在时返回 false
+    bool erase(const uint8_t key[HASH_SIZE]) {
+        auto it = find(key);
+        if (it == entries_.end()) return false;
+        entries_.erase(it);
+        Key k;
+        memcpy(k.data(), key, HASH_SIZE);
+        refresh(std::vector<Key>(1, k));
+        return true;
+    }
+
+    // 查询键对应的值哈希
+    bool get(const uint8_t key[HASH_SIZE], uint8_t valueHash[HASH_SIZE]) const {
+        auto it = find(key);
+        if (it == entries_.end()) return false;
+        memcpy(valueHash, it->value, HASH_SIZE);
+        return true;
+    }
+
+    size_t size() const {
+        return entries_.size();
+    }
+
+    void root(uint8_t out[HASH_SIZE]) const {
+        memcpy(out, root_, HASH_SIZE);
+    }
+
+    // 生成键的存在性或不存在性证明：自根向下，直到子树中至多剩一个叶子。
+    // 兄弟哈希直接取自节点缓存，空兄弟只在位图中记一位。
+    void prove(const uint8_t key[HASH_SIZE], SM3_SparseProof& proof) const {
+        proof = SM3_SparseProof();
+        size_t lo = 0, hi = entries_.size(), depth = 0;
+        uint8_t sib[HASH_SIZE];
+        while (hi - lo >= 2) {
+            size_t mid = split(lo, hi, depth);
+            bool right = bit(key, depth);
+            size_t slo = right ? lo : mid, shi = right ? mid : hi;
+            ++depth;
+            if (slo != shi) {
+                subtree(depth, slo, shi, sib);
+                proof.bitmap[(depth - 1) / 8] |= 0x80 >> ((depth - 1) % 8);
+                proof.siblings.insert(proof.siblings.end(), sib, sib + HASH_SIZE);
+            }
+            if (right) lo = mid;
+            else hi = mid;
+        }
+        proof.depth = depth;
+        if (hi - lo == 1) {
+            proof.hasLeaf = true;
+            memcpy(proof.leafKey, entries_[lo].key, HASH_SIZE);
+            memcpy(proof.leafValue, entries_[lo].value, HASH_SIZE);
+        }
+    }
+
+    // 验证证明：valueHash 非空时证明键存在且值哈希相符，为 nullptr 时证明键不存在。
+    // 自终止节点向上合并 depth 次，空兄弟取预先算好的 E(h)。
+    static bool verify(const uint8_t root[HASH_SIZE], const uint8_t key[HASH_SIZE], const uint8_t* valueHash,
+                       const SM3_SparseProof& proof) {
+        if (proof.depth > DEPTH) return false;
+        size_t present = 0;
+        for (size_t d = 0; d < proof.depth; ++d) present += (proof.bitmap[d / 8] >> (7 - d % 8)) & 1;
+        if (proof.siblings.size() != present * HASH_SIZE) return false;
+
+        uint8_t cur[HASH_SIZE];
+        if (proof.hasLeaf) {
+            // 终止叶子必须位于该键的路径上
+            for (size_t d = 0; d < proof.depth; ++d)
+                if (bit(proof.leafKey, d) != bit(key, d)) return false;
+            bool same = memcmp(proof.leafKey, key, HASH_SIZE) == 0;
+            if (valueHash ? !same || memcmp(proof.leafValue, valueHash, HASH_SIZE) != 0 : same) return false;
+            leaf_hash(proof.leafKey, proof.leafValue, cur);
+        } else {
+            if (valueHash) return false;
+            memcpy(cur, empty(DEPTH - proof.depth), HASH_SIZE);
+        }
+
+        const uint8_t* sib = proof.siblings.data() + proof.siblings.size();
+        for (size_t d = proof.depth; d > 0; --d) {
+            const uint8_t* s = empty(DEPTH - d);
+            if ((proof.bitmap[(d - 1) / 8] >> (7 - (d - 1) % 8)) & 1) s = sib -= HASH_SIZE;
+            if (bit(key, d - 1)) node_hash(s, cur, cur);
+            else node_hash(cur, s, cur);
+        }
+        return memcmp(cur, root, HASH_SIZE) == 0;
+    }
+
+private:
+    typedef std::array<uint8_t, HASH_SIZE> Key;
+
+    struct Entry {
+        uint8_t key[HASH_SIZE];
+        uint8_t value[HASH_SIZE];
+        uint8_t leaf[HASH_SIZE];
+    };
+
+    // 节点由深度和键的前 depth 位确定
+    struct NodeId {
+        Key prefix;
+        size_t depth;
+        bool operator==(const NodeId& o) const {
+            return depth == o.depth && prefix == o.prefix;
+        }
+    };
+
+    struct NodeIdHash {
+        size_t operator()(const NodeId& id) const {
+            uint64_t v;
+            memcpy(&v, id.prefix.data(), sizeof(v));
+            return (size_t)((v ^ id.depth) * 0x9E3779B97F4A7C15ull);
+        }
+    };
+
+    static bool key_less(const Entry& a, const Entry& b) {
+        return memcmp(a.key, b.key, HASH_SIZE) < 0;
+    }
+
+    static bool bit(const uint8_t* key, size_t d) {
+        return (key[d / 8] >> (7 - d % 8)) & 1;
+    }
+
+    static NodeId node_id(const uint8_t* key, size_t depth) {
+        NodeId id;
+        id.depth = depth;
+        id.prefix.fill(0);
+        memcpy(id.prefix.data(), key, depth / 8);
+        if (depth % 8) id.prefix[depth / 8] = key[depth / 8] & (uint8_t)(0xFF00 >> (depth % 8));
+        return id;
+    }
+
+    std::vector<Entry>::const_iterator find(const uint8_t key[HASH_SIZE]) const {
+        Entry probe;
+        memcpy(probe.key, key, HASH_SIZE);
+        auto it = std::lower_bound(entries_.begin(), entries_.end(), probe, key_less);
+        if (it != entries_.end() && memcmp(it->key, key, HASH_SIZE) == 0) return it;
+        return entries_.end();
+    }
+
+    // [lo, hi) 中的键前 depth 位相同，返回第 depth 位为 1 的第一个位置
+    size_t split(size_t lo, size_t hi, size_t depth) const {
+        return std::partition_point(entries_.begin() + lo, entries_.begin() + hi,
+                                    [depth](const Entry& e) { return !bit(e.key, depth); }) - entries_.begin();
+    }
+
+    // 已是最新的子树 [lo, hi) 的哈希：空子树查表，单叶子取叶子哈希，其余取缓存
+    void subtree(size_t depth, size_t lo, size_t hi, uint8_t out[HASH_SIZE]) const {
+        if (lo == hi) memcpy(out, empty(DEPTH - depth), HASH_SIZE);
+        else if (hi - lo == 1) memcpy(out, entries_[lo].leaf, HASH_SIZE);
+        else memcpy(out, cache_.at(node_id(entries_[lo].key, depth)).data(), HASH_SIZE);
+    }
+
+    // 重算包含 dirty（已排序）中任一键的节点，其余子树直接取缓存
+    void refresh(const std::vector<Key>& dirty) {
+        update(0, 0, entries_.size(), dirty.data(), dirty.data() + dirty.size(), root_);
+    }
+
+    void update(size_t depth, size_t lo, size_t hi, const Key* dlo, const Key* dhi, uint8_t out[HASH_SIZE]) {
+        if (dlo == dhi) {
+            subtree(depth, lo, hi, out);
+            return;
+        }
+        if (hi - lo < 2) {
+            // 子树已不足两个叶子：沿被改动的路径丢弃失效的缓存节点
+            for (const Key* k = dlo; k != dhi; ++k)
+                for (size_t d = depth; d < DEPTH && cache_.erase(node_id(k->data(), d)); ++d) {
+                }
+            subtree(depth, lo, hi, out);
+            return;
+        }
+        size_t mid = split(lo, hi, depth);
+        const Key* dmid = std::partition_point(dlo, dhi, [depth](const Key& k) { return !bit(k.data(), depth); });
+        uint8_t children[2 * HASH_SIZE];
+        update(depth + 1, lo, mid, dlo, dmid, children);
+        update(depth + 1, mid, hi, dmid, dhi, children + HASH_SIZE);
+        Key& node = cache_[node_id(entries_[lo].key, depth)];
+        SM3::hash(nodePrefix_, children, sizeof(children), node.data());
+        memcpy(out, node.data(), HASH_SIZE);
+    }
+
+    SM3_MIDSTATE leafPrefix_, nodePrefix_;
+    std::vector<Entry> entries_;                          // 按键排序的叶子
+    std::unordered_map<NodeId, Key, NodeIdHash> cache_;   // 至少含两个叶子的节点的哈希
+    uint8_t root_[HASH_SIZE];
+};
+
+#endif // SM3_SMT_H
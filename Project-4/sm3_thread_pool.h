@@ -0,0 +1,95 @@
+// Project-4 各程序共用的简单线程池（仅头文件）
+#ifndef SM3_THREAD_POOL_H
+#define SM3_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sm3_detail {
+
+// 固定数量的工作线程，parallel_for 把 [0, n) 分给工作线程和调用线程
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads) {
+        for (unsigned i = 1; i < threads; ++i) {
+            workers_.emplace_back([this] { work(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& t : workers_) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void parallel_for(size_t n, const std::function<void(size_t)>& fn) {
+        if (workers_.empty() || n <= 1) {
+            for (size_t i = 0; i < n; ++i) fn(i);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &fn;
+            jobSize_ = n;
+            next_ = 0;
+            busy_ = workers_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+        run(fn, n);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return busy_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    void run(const std::function<void(size_t)>& fn, size_t n) {
+        for (size_t i; (i = next_.fetch_add(1)) < n;) fn(i);
+    }
+
+    void work() {
+        uint64_t seen = 0;
+        for (;;) {
+            const std::function<void(size_t)>* fn;
+            size_t n;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+                fn = job_;
+                n = jobSize_;
+            }
+            run(*fn, n);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_ == 0) done_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    const std::function<void(size_t)>* job_ = nullptr;
+    size_t jobSize_ = 0;
+    std::atomic<size_t> next_{0};
+    size_t busy_ = 0;
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+};
+
+} // namespace sm3_detail
+
+#endif // SM3_THREAD_POOL_H
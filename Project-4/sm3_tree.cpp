@@ -0,0 +1,141 @@
+// 基于 SM3 的 RFC 6962 Merkle 树演示
+//
+// 用法: sm3_tree [叶子数]，默认 100000
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <random>
+#include "sm3_merkle.h"
+
+void printHex(const uint8_t* d, size_t len) {
+    for (size_t i=0;i<len;i++)
+        std::cout<<std::hex<<std::setw(2)<<std::setfill('0')<<int(d[i]);
+    std::cout<<std::dec<<std::endl;
+}
+
+// 按 RFC 6962 的递归定义计算 MTH(D[begin:end])，用于对照
+void referenceRoot(const std::vector<std::string>& leaves, size_t begin, size_t end, uint8_t out[32]) {
+    size_t n = end - begin;
+    if (n == 1) {
+        SM3_MerkleTree::leaf_hash((const uint8_t*)leaves[begin].data(), leaves[begin].size(), out);
+        return;
+    }
+    size_t k = 1;
+    while (k * 2 < n) k *= 2;
+    uint8_t left[32], right[32];
+    referenceRoot(leaves, begin, begin + k, left);
+    referenceRoot(leaves, begin + k, end, right);
+    SM3_MerkleTree::node_hash(left, right, out);
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    if (n == 0) n = 1;
+
+    std::vector<std::string> leaves(n);
+    std::vector<const uint8_t*> ptrs(n);
+    std::vector<size_t> lens(n);
+    for (size_t i=0;i<n;i++) {
+        leaves[i] = "leaf-" + std::to_string(i);
+        ptrs[i] = (const uint8_t*)leaves[i].data();
+        lens[i] = leaves[i].size();
+    }
+
+    SM3_MerkleTree tree;
+    auto t0=std::chrono::high_resolution_clock::now();
+    tree.build(ptrs.data(), lens.data(), n);
+    auto t1=std::chrono::high_resolution_clock::now();
+
+    uint8_t root[32], expect[32];
+    tree.root(root);
+    auto t2=std::chrono::high_resolution_clock::now();
+    referenceRoot(leaves, 0, n, expect);
+    auto t3=std::chrono::high_resolution_clock::now();
+
+    std::cout<<"叶子数: "<<n<<std::endl;
+    std::cout<<"Merkle 根: ";
+    printHex(root, 32);
+    std::cout<<"  构建耗时: "<<std::chrono::duration<double>(t1-t0).count()*1000<<" ms"<<std::endl;
+    std::cout<<"  递归定义: "<<std::chrono::duration<double>(t3-t2).count()*1000<<" ms，结果"
+             <<(memcmp(root, expect, 32)==0?"一致":"不一致")<<std::endl;
+
+    // 日志的追加：每批 1000 个叶子，最后 10 个逐个追加，根在每次追加后立即可用
+    SM3_MerkleTree log;
+    size_t batchSize=1000, tailCount=std::min<size_t>(n, 10), bulk=n-tailCount;
+    auto a0=std::chrono::high_resolution_clock::now();
+    for (size_t first=0; first<bulk; first+=batchSize) {
+        size_t k=std::min(batchSize, bulk-first);
+        log.append_many(ptrs.data()+first, lens.data()+first, k);
+    }
+    for (size_t i=bulk;i<n;i++) log.append(ptrs[i], lens[i]);
+    auto a1=std::chrono::high_resolution_clock::now();
+    uint8_t logRoot[32];
+    log.root(logRoot);
+    double appendMs=std::chrono::duration<double>(a1-a0).count()*1000;
+    std::cout<<"  分批追加: "<<appendMs<<" ms（"<<n/appendMs/1000<<" 百万叶子/秒），根"
+             <<(memcmp(logRoot, root, 32)==0?"一致":"不一致")<<std::endl;
+
+    // 为每个叶子生成存在性证明，分别逐个验证和批量验证
+    size_t h = tree.height();
+    std::vector<uint8_t> leafHashes(n*32), proofs(n*h*32);
+    std::vector<size_t> counts(n);
+    for (size_t i=0;i<n;i++)
+        SM3_MerkleTree::leaf_hash(ptrs[i], lens[i], leafHashes.data()+i*32);
+
+    auto t4=std::chrono::high_resolution_clock::now();
+    for (size_t i=0;i<n;i++)
+        counts[i] = tree.inclusion_proof(i, proofs.data()+i*h*32);
+    auto t5=std::chrono::high_resolution_clock::now();
+    size_t single=0;
+    for (size_t i=0;i<n;i++)
+        single += SM3_MerkleTree::verify_inclusion(leafHashes.data()+i*32, i, n, proofs.data()+i*h*32, counts[i], root);
+    auto t6=std::chrono::high_resolution_clock::now();
+
+    std::vector<SM3_InclusionCheck> checks(n);
+    for (size_t i=0;i<n;i++)
+        checks[i] = {leafHashes.data()+i*32, i, n, proofs.data()+i*h*32, counts[i], root};
+    checks[n/2].index ^= 1;  // 篡改一个证明，应被拒绝（n 为 1 时越界，同样被拒绝）
+    std::unique_ptr<bool[]> ok(new bool[n]);
+    auto t7=std::chrono::high_resolution_clock::now();
+    SM3_MerkleTree::verify_inclusion_many(checks.data(), n, ok.get());
+    auto t8=std::chrono::high_resolution_clock::now();
+    size_t batch=0;
+    for (size_t i=0;i<n;i++) batch += ok[i];
+
+    double singleMs=std::chrono::duration<double>(t6-t5).count()*1000;
+    double batchMs=std::chrono::duration<double>(t8-t7).count()*1000;
+    std::cout<<"存在性证明（树高 "<<h<<"）:"<<std::endl;
+    std::cout<<"  生成 "<<n<<" 个: "<<std::chrono::duration<double>(t5-t4).count()*1000<<" ms"<<std::endl;
+    std::cout<<"  逐个验证: "<<singleMs<<" ms，通过 "<<single<<" 个"<<std::endl;
+    std::cout<<"  批量验证: "<<batchMs<<" ms（"<<singleMs/batchMs<<" 倍），通过 "<<batch
+             <<" 个（其中 1 个已篡改）"<<std::endl;
+
+    // 审计者持有某个历史大小 m 的根，反复请求到当前大小 n 的一致性证明
+    const size_t AUDITS=1000;
+    std::vector<size_t> sizes(AUDITS);
+    std::mt19937_64 rng(2024);
+    for (size_t i=0;i<AUDITS;i++) sizes[i]=1+rng()%n;
+    std::vector<uint8_t> cproof((h+1)*32);
+    size_t consistent=0;
+    double passMs[2];
+    for (int pass=0; pass<2; pass++) {
+        passMs[pass]=0;
+        for (size_t m : sizes) {
+            uint8_t old[32];
+            auto c0=std::chrono::high_resolution_clock::now();
+            tree.root_at(m, old);
+            size_t c = tree.consistency_proof(m, n, cproof.data());
+            passMs[pass]+=std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-c0).count()*1000;
+            consistent += SM3_MerkleTree::verify_consistency(m, n, old, root, cproof.data(), c);
+        }
+    }
+    std::cout<<"一致性证明（"<<AUDITS<<" 个随机历史大小，各请求两轮）:"<<std::endl;
+    std::cout<<"  生成历史根和证明: 首轮 "<<passMs[0]<<" ms，次轮（已缓存） "<<passMs[1]<<" ms；验证通过 "
+             <<consistent<<" / "<<2*AUDITS<<std::endl;
+    return 0;
+}
@@ -0,0 +1,166 @@
+// SM3 树哈希模式（仅头文件）：定长分块并行哈希，再按固定扇出逐层合并。
+// 结果与普通 SM3 不同，只用于两端都使用本模式的内部完整性校验。
+//
+//   叶子 = SM3(0x00 || 分块)
+//   节点 = SM3(0x01 || 子节点摘要 ...)，每组至多 fanout 个，落单的末尾节点直接上移
+//   根   = SM3(0x02 || 总长度 || 分块大小 || 扇出 || 顶层摘要)，长度均为大端 64 位
+#ifndef SM3_TREE_HASH_H
+#define SM3_TREE_HASH_H
+
+#include "sm3_core.h"
+#include "sm3_thread_pool.h"
+
+#include <string>
+
+struct SM3_TreeParams {
+    size_t leafSize = 64 * 1024;  // 分块大小（字节）
+    unsigned fanout = 2;          // 每个内部节点的子节点数上限，至少为 2
+    unsigned threads = 0;         // 0 表示使用硬件线程数
+};
+
+class SM3_TreeHash {
+public:
+    explicit SM3_TreeHash(const SM3_TreeParams& params = SM3_TreeParams())
+        : params_(params),
+          pool_(thread_count(params)),
+          batchLeaves_((size_t)thread_count(params) * GROUP) {
+        if (params_.leafSize == 0) params_.leafSize = 64 * 1024;
+        if (params_.fanout < 2) params_.fanout = 2;
+
+        static const uint8_t leafTag = 0x00, nodeTag = 0x01;
+        SM3::midstate(&leafTag, 1, leafPrefix_);
+        SM3::midstate(&nodeTag, 1, nodePrefix_);
+    }
+
+    const SM3_TreeParams& params() const {
+        return params_;
+    }
+
+    // 凑满一批分块后并行哈希；调用者缓冲区中的整批分块直接哈希，不做拷贝
+    void update(const uint8_t* data, size_t len) {
+        size_t batchBytes = batchLeaves_ * params_.leafSize;
+        total_ += len;
+        while (len > 0) {
+            if (pending_.empty() && len >= batchBytes) {
+                hash_leaves(data, batchBytes);
+                data += batchBytes;
+                len -= batchBytes;
+                continue;
+            }
+            size_t take = std::min(batchBytes - pending_.size(), len);
+            pending_.insert(pending_.end(), data, data + take);
+            data += take;
+            len -= take;
+            if (pending_.size() == batchBytes) {
+                hash_leaves(pending_.data(), pending_.size());
+                pending_.clear();
+            }
+        }
+    }
+
+    void final(uint8_t digest[32]) {
+        // 空输入也有一个（空的）叶子
+        static const uint8_t empty = 0;
+        if (!pending_.empty() || leaves_.empty()) {
+            hash_leaves(pending_.empty() ? &empty : pending_.data(), pending_.size());
+            pending_.clear();
+        }
+
+        std::vector<uint8_t> level;
+        level.swap(leaves_);
+        while (level.size() > 32) level = reduce(level);
+
+        uint8_t root[1 + 8 + 8 + 8 + 32];
+        root[0] = 0x02;
+        store_be64(root + 1, total_);
+        store_be64(root + 9, params_.leafSize);
+        store_be64(root + 17, params_.fanout);
+        memcpy(root + 25, level.data(), 32);
+        SM3::hash(root, sizeof(root), digest);
+        total_ = 0;
+    }
+
+    static void hash(const uint8_t* data, size_t len, const SM3_TreeParams& params, uint8_t digest[32]) {
+        SM3_TreeHash h(params);
+        h.update(data, len);
+        h.final(digest);
+    }
+
+    // 输出中带上参数，校验方据此使用相同的分块大小与扇出
+    static std::string format(const SM3_TreeParams& params, const uint8_t digest[32]) {
+        static const char hex[] = "0123456789abcdef";
+        std::string s = "sm3tree:leaf=" + std::to_string(params.leafSize) +
+                        ":fanout=" + std::to_string(params.fanout) + ":";
+        for (int i = 0; i < 32; ++i) {
+            s += hex[digest[i] >> 4];
+            s += hex[digest[i] & 15];
+        }
+        return s;
+    }
+
+private:
+    // 每个任务用一次多缓冲调用哈希 GROUP 个分块（或节点）
+    static constexpr size_t GROUP = 16;
+
+    static unsigned thread_count(const SM3_TreeParams& p) {
+        return p.threads ? p.threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    static void store_be64(uint8_t* p, uint64_t v) {
+        sm3_detail::store_be32(p, (uint32_t)(v >> 32));
+        sm3_detail::store_be32(p + 4, (uint32_t)v);
+    }
+
+    // 把 [data, data + len) 切成分块追加到叶子摘要中，只有最后一批允许出现不满的分块
+    void hash_leaves(const uint8_t* data, size_t len) {
+        size_t count = len == 0 ? 1 : (len + params_.leafSize - 1) / params_.leafSize;
+        size_t base = leaves_.size();
+        leaves_.resize(base + count * 32);
+        uint8_t* out = leaves_.data() + base;
+
+        pool_.parallel_for((count + GROUP - 1) / GROUP, [&](size_t task) {
+            const uint8_t* ptrs[GROUP];
+            size_t lens[GROUP];
+            size_t first = task * GROUP, k = std::min(GROUP, count - first);
+            for (size_t i = 0; i < k; ++i) {
+                size_t off = (first + i) * params_.leafSize;
+                ptrs[i] = data + off;
+                lens[i] = std::min(params_.leafSize, len - off);
+            }
+            SM3::hash_many(leafPrefix_, ptrs, lens, k, out + first * 32);
+        });
+    }
+
+    // 合并一层：每 fanout 个摘要哈希成一个父节点，落单的末尾节点原样上移
+    std::vector<uint8_t> reduce(const std::vector<uint8_t>& level) {
+        size_t n = level.size() / 32, f = params_.fanout;
+        size_t parents = (n + f - 1) / f;
+        std::vector<uint8_t> up(parents * 32);
+        bool lone = n % f == 1;
+        size_t hashed = lone ? parents - 1 : parents;
+        if (lone) memcpy(up.data() + hashed * 32, level.data() + (n - 1) * 32, 32);
+
+        pool_.parallel_for((hashed + GROUP - 1) / GROUP, [&](size_t task) {
+            const uint8_t* ptrs[GROUP];
+            size_t lens[GROUP];
+            size_t first = task * GROUP, k = std::min(GROUP, hashed - first);
+            for (size_t i = 0; i < k; ++i) {
+                size_t child = (first + i) * f;
+                ptrs[i] = level.data() + child * 32;
+                lens[i] = std::min(f, n - child) * 32;
+            }
+            SM3::hash_many(nodePrefix_, ptrs, lens, k, up.data() + first * 32);
+        });
+        return up;
+    }
+
+    SM3_TreeParams params_;
+    sm3_detail::ThreadPool pool_;
+    size_t batchLeaves_;
+    SM3_MIDSTATE leafPrefix_, nodePrefix_;
+    std::vector<uint8_t> pending_;
+    std::vector<uint8_t> leaves_;
+    uint64_t total_ = 0;
+};
+
+#endif // SM3_TREE_HASH_H
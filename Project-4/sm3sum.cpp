@@ -0,0 +1,473 @@
+// sm3sum：与 sha256sum 输出格式和 -c 校验格式兼容的 SM3 校验和工具
+//
+// 用法: sm3sum [选项] [文件或目录]...
+//   -b, --binary      输出中以 '*' 标记二进制模式
+//   -t, --text        输出中以 ' ' 标记文本模式（默认）
+//   -c, --check       从给定文件中读取校验和并逐个校验
+//       --quiet       校验时不输出成功的文件
+//       --status      校验时不输出任何内容，只通过退出码表示结果
+//       --ignore-missing  校验时跳过不存在的文件
+//   -w, --warn        校验时对格式不正确的行给出警告
+//   -r, --recursive   递归处理目录中的所有文件（sha256sum 没有此选项）
+//   -j, --threads N   并行的线程数，默认使用硬件线程数
+//
+// 大文件按 1 MB 对齐的块顺序读取（POSIX 下配合 posix_fadvise 预读），
+// 小文件整批读入内存后交给多缓冲的 SM3::hash_many，文件之间在线程池上并行。
+#include <iostream>
+#include <fstream>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <filesystem>
+#include "sm3_core.h"
+#include "sm3_thread_pool.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+struct Options {
+    bool check = false;
+    bool binary = false;
+    bool quiet = false;
+    bool status = false;
+    bool ignoreMissing = false;
+    bool warn = false;
+    bool recursive = false;
+    unsigned threads = 0;
+};
+
+struct Entry {
+    std::string name;
+    uint64_t size = 0;
+    bool small = false;
+    bool ok = false;
+    bool missing = false;
+    std::string error;
+    uint8_t digest[32];
+    uint8_t expected[32];  // 仅校验模式
+};
+
+// 不超过该大小的文件走多缓冲批处理
+const uint64_t SMALL_FILE = 64 * 1024;
+const size_t SMALL_BATCH = 64;
+const size_t CHUNK = 1 << 20;
+
+// 按页对齐的读缓冲区
+struct alignas(4096) Chunk {
+    uint8_t data[CHUNK];
+};
+
+static std::string errorText(int err) {
+    return std::strerror(err);
+}
+
+#ifdef _WIN32
+static int openFile(const std::string& name) {
+    if (name == "-") {
+        _setmode(0, _O_BINARY);
+        return 0;
+    }
+    return _open(name.c_str(), _O_RDONLY | _O_BINARY);
+}
+static long readFile(int fd, uint8_t* buf, size_t len) {
+    return _read(fd, buf, (unsigned)len);
+}
+static void closeFile(int fd) {
+    if (fd != 0) _close(fd);
+}
+static void adviseSequential(int) {}
+#else
+static int openFile(const std::string& name) {
+    return name == "-" ? 0 : open(name.c_str(), O_RDONLY);
+}
+static long readFile(int fd, uint8_t* buf, size_t len) {
+    ssize_t n;
+    do {
+        n = read(fd, buf, len);
+    } while (n < 0 && errno == EINTR);
+    return (long)n;
+}
+static void closeFile(int fd) {
+    if (fd != 0) close(fd);
+}
+static void adviseSequential(int fd) {
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#else
+    (void)fd;
+#endif
+}
+#endif
+
+// 大文件（或标准输入）：流式哈希，每次读入一个对齐的 1 MB 块
+static void hashLarge(Entry& e, uint8_t* chunk) {
+    int fd = openFile(e.name);
+    if (fd < 0) {
+        e.missing = errno == ENOENT;
+        e.error = errorText(errno);
+        return;
+    }
+    adviseSequential(fd);
+
+    SM3_CTX ctx;
+    SM3::init(ctx);
+    for (;;) {
+        long n = readFile(fd, chunk, CHUNK);
+        if (n < 0) {
+            e.error = errorText(errno);
+            closeFile(fd);
+            return;
+        }
+        if (n == 0) break;
+        SM3::update(ctx, chunk, (size_t)n);
+    }
+    closeFile(fd);
+    SM3::final(ctx, e.digest);
+    e.ok = true;
+}
+
+// 读入整个小文件；文件在 stat 之后变大时读到的内容以实际为准
+static bool readSmall(Entry& e, std::vector<uint8_t>& data) {
+    int fd = openFile(e.name);
+    if (fd < 0) {
+        e.missing = errno == ENOENT;
+        e.error = errorText(errno);
+        return false;
+    }
+    data.resize((size_t)e.size + 1);
+    size_t got = 0;
+    for (;;) {
+        if (got == data.size()) data.resize(data.size() * 2);
+        long n = readFile(fd, data.data() + got, data.size() - got);
+        if (n < 0) {
+            e.error = errorText(errno);
+            closeFile(fd);
+            return false;
+        }
+        if (n == 0) break;
+        got += (size_t)n;
+    }
+    closeFile(fd);
+    data.resize(got);
+    return true;
+}
+
+static void hashSmallBatch(std::vector<Entry>& entries, const size_t* idx, size_t n) {
+    std::vector<std::vector<uint8_t>> data(n);
+    std::vector<const uint8_t*> ptrs;
+    std::vector<size_t> lens, which;
+    for (size_t i = 0; i < n; ++i) {
+        if (!readSmall(entries[idx[i]], data[i])) continue;
+        ptrs.push_back(data[i].data());
+        lens.push_back(data[i].size());
+        which.push_back(idx[i]);
+    }
+    std::vector<uint8_t> digests(ptrs.size() * 32);
+    SM3::hash_many(ptrs.data(), lens.data(), ptrs.size(), digests.data());
+    for (size_t i = 0; i < which.size(); ++i) {
+        memcpy(entries[which[i]].digest, digests.data() + i * 32, 32);
+        entries[which[i]].ok = true;
+    }
+}
+
+// 并行计算所有条目的摘要，emit 按输入顺序依次调用
+template <class Emit>
+static void hashEntries(std::vector<Entry>& entries, unsigned threads, Emit emit) {
+    std::vector<std::vector<size_t>> tasks;
+    std::vector<size_t> group;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (!entries[i].small) {
+            tasks.push_back({i});
+            continue;
+        }
+        group.push_back(i);
+        if (group.size() == SMALL_BATCH) {
+            tasks.push_back(group);
+            group.clear();
+        }
+    }
+    if (!group.empty()) tasks.push_back(group);
+
+    std::vector<char> done(entries.size(), 0);
+    size_t printed = 0;
+    std::mutex printMutex;
+
+    sm3_detail::ThreadPool pool(threads);
+    pool.parallel_for(tasks.size(), [&](size_t t) {
+        const std::vector<size_t>& task = tasks[t];
+        if (entries[task[0]].small) {
+            hashSmallBatch(entries, task.data(), task.size());
+        } else {
+            std::unique_ptr<Chunk> chunk(new Chunk);
+            hashLarge(entries[task[0]], chunk->data);
+        }
+
+        std::lock_guard<std::mutex> lock(printMutex);
+        for (size_t i : task) done[i] = 1;
+        while (printed < entries.size() && done[printed]) emit(entries[printed++]);
+    });
+}
+
+// 与 sha256sum 相同：文件名含 '\\' 或换行时，行首加 '\\' 并转义
+static std::string escapeName(const std::string& name, bool& escaped) {
+    escaped = name.find_first_of("\\\n") != std::string::npos;
+    if (!escaped) return name;
+    std::string out;
+    for (char c : name) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\n') out += "\\n";
+        else out += c;
+    }
+    return out;
+}
+
+static bool unescapeName(const std::string& in, std::string& out) {
+    out.clear();
+    for (size_t i = 0; i < in.size(); ++i) {
+        if (in[i] != '\\') {
+            out += in[i];
+            continue;
+        }
+        if (++i == in.size()) return false;
+        if (in[i] == '\\') out += '\\';
+        else if (in[i] == 'n') out += '\n';
+        else return false;
+    }
+    return true;
+}
+
+static std::string toHex(const uint8_t* d) {
+    static const char hex[] = "0123456789abcdef";
+    std::string s;
+    for (int i = 0; i < 32; ++i) {
+        s += hex[d[i] >> 4];
+        s += hex[d[i] & 15];
+    }
+    return s;
+}
+
+static bool fromHex(const std::string& s, uint8_t* d) {
+    if (s.size() != 64) return false;
+    for (int i = 0; i < 32; ++i) {
+        int v = 0;
+        for (int k = 0; k < 2; ++k) {
+            char c = s[i * 2 + k];
+            int x = c >= '0' && c <= '9' ? c - '0'
+                  : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                  : c >= 'A' && c <= 'F' ? c - 'A' + 10 : -1;
+            if (x < 0) return false;
+            v = v * 16 + x;
+        }
+        d[i] = (uint8_t)v;
+    }
+    return true;
+}
+
+static Entry makeEntry(const std::string& name, uint64_t size, bool regular) {
+    Entry e;
+    e.name = name;
+    e.size = size;
+    e.small = regular && size <= SMALL_FILE;
+    return e;
+}
+
+// 展开命令行参数：目录在 -r 下递归展开（按路径排序），否则报错
+static bool collect(const std::string& arg, const Options& opt, std::vector<Entry>& out) {
+    if (arg == "-") {
+        out.push_back(makeEntry(arg, 0, false));
+        return true;
+    }
+    std::error_code ec;
+    fs::file_status st = fs::status(arg, ec);
+    if (fs::is_directory(st)) {
+        if (!opt.recursive) {
+            std::cerr<<"sm3sum: "<<arg<<": Is a directory"<<std::endl;
+            return false;
+        }
+        std::vector<std::string> files;
+        for (fs::recursive_directory_iterator it(arg, ec), end; !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec)) files.push_back(it->path().string());
+        }
+        if (ec) {
+            std::cerr<<"sm3sum: "<<arg<<": "<<ec.message()<<std::endl;
+            return false;
+        }
+        std::sort(files.begin(), files.end());
+        for (const std::string& f : files) {
+            std::error_code sizeEc;
+            uint64_t size = fs::file_size(f, sizeEc);
+            out.push_back(makeEntry(f, sizeEc ? 0 : size, !sizeEc));
+        }
+        return true;
+    }
+    bool regular = fs::is_regular_file(st);
+    uint64_t size = regular ? fs::file_size(arg, ec) : 0;
+    out.push_back(makeEntry(arg, ec ? 0 : size, regular && !ec));
+    return true;
+}
+
+static int computeMode(const std::vector<std::string>& args, const Options& opt) {
+    bool failed = false;
+    std::vector<Entry> entries;
+    for (const std::string& a : args) failed |= !collect(a, opt, entries);
+
+    hashEntries(entries, opt.threads, [&](const Entry& e) {
+        if (!e.ok) {
+            std::cerr<<"sm3sum: "<<e.name<<": "<<e.error<<std::endl;
+            failed = true;
+            return;
+        }
+        bool escaped;
+        std::string name = escapeName(e.name, escaped);
+        std::cout<<(escaped ? "\\" : "")<<toHex(e.digest)<<' '<<(opt.binary ? '*' : ' ')<<name<<'\n';
+    });
+    std::cout.flush();
+    return failed ? 1 : 0;
+}
+
+// 解析一行 "<64 位十六进制>  <文件名>" 或 "<64 位十六进制> *<文件名>"
+static bool parseLine(std::string line, Entry& e) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    bool escaped = !line.empty() && line[0] == '\\';
+    if (escaped) line.erase(0, 1);
+    if (line.size() < 67 || line[64] != ' ' || (line[65] != ' ' && line[65] != '*')) return false;
+    if (!fromHex(line.substr(0, 64), e.expected)) return false;
+    std::string name = line.substr(66);
+    if (escaped && !unescapeName(name, e.name)) return false;
+    if (!escaped) e.name = name;
+    return !e.name.empty();
+}
+
+static int checkFile(const std::string& listName, const Options& opt) {
+    std::ifstream fileIn;
+    std::istream* in = &std::cin;
+    if (listName != "-") {
+        fileIn.open(listName, std::ios::binary);
+        if (!fileIn) {
+            std::cerr<<"sm3sum: "<<listName<<": "<<errorText(errno)<<std::endl;
+            return 1;
+        }
+        in = &fileIn;
+    }
+
+    std::vector<Entry> entries;
+    size_t badLines = 0, lineNo = 0;
+    std::string line;
+    while (std::getline(*in, line)) {
+        ++lineNo;
+        Entry e;
+        if (!parseLine(line, e)) {
+            ++badLines;
+            if (opt.warn) {
+                std::cerr<<"sm3sum: "<<listName<<": "<<lineNo<<": improperly formatted SM3 checksum line"<<std::endl;
+            }
+            continue;
+        }
+        std::error_code ec;
+        fs::file_status st = fs::status(e.name, ec);
+        bool regular = fs::is_regular_file(st);
+        uint64_t size = regular ? fs::file_size(e.name, ec) : 0;
+        Entry full = makeEntry(e.name, ec ? 0 : size, regular && !ec);
+        memcpy(full.expected, e.expected, 32);
+        entries.push_back(full);
+    }
+
+    if (entries.empty()) {
+        std::cerr<<"sm3sum: "<<listName<<": no properly formatted SM3 checksum lines found"<<std::endl;
+        return 1;
+    }
+
+    size_t mismatched = 0, unreadable = 0, verified = 0;
+    hashEntries(entries, opt.threads, [&](const Entry& e) {
+        if (!e.ok) {
+            if (opt.ignoreMissing && e.missing) return;
+            ++unreadable;
+            if (!opt.status) {
+                std::cerr<<"sm3sum: "<<e.name<<": "<<e.error<<std::endl;
+                std::cout<<e.name<<": FAILED open or read\n";
+            }
+            return;
+        }
+        ++verified;
+        bool match = memcmp(e.digest, e.expected, 32) == 0;
+        if (!match) ++mismatched;
+        if (opt.status || (match && opt.quiet)) return;
+        std::cout<<e.name<<": "<<(match ? "OK" : "FAILED")<<'\n';
+    });
+    std::cout.flush();
+
+    if (!opt.status) {
+        if (badLines) {
+            std::cerr<<"sm3sum: WARNING: "<<badLines<<" line"<<(badLines > 1 ? "s are" : " is")
+                     <<" improperly formatted"<<std::endl;
+        }
+        if (unreadable) {
+            std::cerr<<"sm3sum: WARNING: "<<unreadable<<" listed file"<<(unreadable > 1 ? "s" : "")
+                     <<" could not be read"<<std::endl;
+        }
+        if (mismatched) {
+            std::cerr<<"sm3sum: WARNING: "<<mismatched<<" computed checksum"<<(mismatched > 1 ? "s" : "")
+                     <<" did NOT match"<<std::endl;
+        }
+    }
+    if (opt.ignoreMissing && verified == 0 && mismatched == 0 && unreadable == 0) {
+        if (!opt.status) std::cerr<<"sm3sum: "<<listName<<": no file was verified"<<std::endl;
+        return 1;
+    }
+    return mismatched || unreadable ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+    std::vector<std::string> args;
+    bool endOfOptions = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (endOfOptions || a == "-" || a[0] != '-') {
+            args.push_back(a);
+        } else if (a == "--") {
+            endOfOptions = true;
+        } else if (a == "-b" || a == "--binary") {
+            opt.binary = true;
+        } else if (a == "-t" || a == "--text") {
+            opt.binary = false;
+        } else if (a == "-c" || a == "--check") {
+            opt.check = true;
+        } else if (a == "--quiet") {
+            opt.quiet = true;
+        } else if (a == "--status") {
+            opt.status = true;
+        } else if (a == "--ignore-missing") {
+            opt.ignoreMissing = true;
+        } else if (a == "-w" || a == "--warn") {
+            opt.warn = true;
+        } else if (a == "-r" || a == "--recursive") {
+            opt.recursive = true;
+        } else if ((a == "-j" || a == "--threads") && i + 1 < argc) {
+            opt.threads = (unsigned)std::strtoul(argv[++i], nullptr, 10);
+        } else {
+            std::cerr<<"sm3sum: 无效的选项 "<<a<<std::endl;
+            return 1;
+        }
+    }
+    if (opt.threads == 0) opt.threads = std::max(1u, std::thread::hardware_concurrency());
+    if (args.empty()) args.push_back("-");
+
+    if (!opt.check) return computeMode(args, opt);
+
+    int rc = 0;
+    for (const std::string& a : args) rc |= checkFile(a, opt);
+    return rc;
+}